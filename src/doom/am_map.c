@@ -224,6 +224,10 @@ static void AM_transformPoint (mpoint_t *pt);
 static mpoint_t mapcenter;
 static angle_t mapangle;
 
+// [crispy] rotate with the view, or keep the map static in overlay mode
+#define AM_rotationAngle() \
+    (followplayer || !automap_overlay ? ANG90 - viewangle : mapangle)
+
 // -----------------------------------------------------------------------------
 // AM_Init
 // [JN] Predefine some variables at program startup.
@@ -391,6 +395,177 @@ static void AM_findMinMaxBoundaries (void)
     max_scale_mtof = FixedDiv(f_h<<FRACBITS, 2*FRACUNIT);
 }
 
+// -----------------------------------------------------------------------------
+// AM_initLineGrid
+//  [JN] Bins linedefs into a coarse grid over the map bounds, by their
+//  bounding boxes. Every frame, only the lines in cells that the map window
+//  touches are drawn. The grid is kept as one array of line numbers, sorted
+//  by cell, with the first entry of every cell in grid_first.
+// -----------------------------------------------------------------------------
+
+#define AM_GRIDCELLS 32 // cells along each side of the grid
+
+static int  grid_first[AM_GRIDCELLS * AM_GRIDCELLS + 1];
+static int *grid_lines;
+static int  grid_cellw, grid_cellh;
+
+// Lines found in the touched cells have their frame stamp set.
+static int *line_stamp;
+static int  line_stampnum;
+
+// Transformed vertexes, see AM_transformVertexes.
+static mpoint_t *am_vertexes;
+static boolean   am_vertexes_valid;
+
+static void AM_lineCells (const line_t *line, int *x1, int *x2, int *y1, int *y2)
+{
+    const fixed_t ax = line->v1->x >> FRACTOMAPBITS, ay = line->v1->y >> FRACTOMAPBITS;
+    const fixed_t bx = line->v2->x >> FRACTOMAPBITS, by = line->v2->y >> FRACTOMAPBITS;
+
+    *x1 = BETWEEN(0, AM_GRIDCELLS - 1, (MIN(ax, bx) - min_x) / grid_cellw);
+    *x2 = BETWEEN(0, AM_GRIDCELLS - 1, (MAX(ax, bx) - min_x) / grid_cellw);
+    *y1 = BETWEEN(0, AM_GRIDCELLS - 1, (MIN(ay, by) - min_y) / grid_cellh);
+    *y2 = BETWEEN(0, AM_GRIDCELLS - 1, (MAX(ay, by) - min_y) / grid_cellh);
+}
+
+static void AM_initLineGrid (void)
+{
+    int cursor[AM_GRIDCELLS * AM_GRIDCELLS];
+    int x1, x2, y1, y2;
+
+    grid_cellw = max_w / AM_GRIDCELLS + 1;
+    grid_cellh = max_h / AM_GRIDCELLS + 1;
+
+    // Count the lines of every cell, then turn the counts into offsets.
+    memset(cursor, 0, sizeof(cursor));
+
+    for (int i = 0; i < numlines; i++)
+    {
+        AM_lineCells(&lines[i], &x1, &x2, &y1, &y2);
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                cursor[y * AM_GRIDCELLS + x]++;
+    }
+
+    grid_first[0] = 0;
+
+    for (int c = 0; c < AM_GRIDCELLS * AM_GRIDCELLS; c++)
+    {
+        grid_first[c + 1] = grid_first[c] + cursor[c];
+        cursor[c] = grid_first[c];
+    }
+
+    grid_lines = I_Realloc(grid_lines, MAX(1, grid_first[AM_GRIDCELLS * AM_GRIDCELLS])
+                                       * sizeof(*grid_lines));
+
+    for (int i = 0; i < numlines; i++)
+    {
+        AM_lineCells(&lines[i], &x1, &x2, &y1, &y2);
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                grid_lines[cursor[y * AM_GRIDCELLS + x]++] = i;
+    }
+
+    line_stamp = I_Realloc(line_stamp, MAX(1, numlines) * sizeof(*line_stamp));
+    memset(line_stamp, 0, MAX(1, numlines) * sizeof(*line_stamp));
+    line_stampnum = 0;
+
+    am_vertexes = I_Realloc(am_vertexes, MAX(1, numvertexes) * sizeof(*am_vertexes));
+    am_vertexes_valid = false;
+}
+
+// -----------------------------------------------------------------------------
+// AM_markVisibleLines
+//  [JN] Stamps the lines in the grid cells touched by the map window.
+//  Rotation and the square aspect ratio transform about the window center,
+//  so the window is grown to cover what they bring into view. Returns true
+//  if every cell is touched, and all lines have to be checked anyway.
+// -----------------------------------------------------------------------------
+
+static boolean AM_markVisibleLines (void)
+{
+    int64_t hw = m_w / 2, hh = m_h / 2;
+    int x1, x2, y1, y2;
+
+    if (ADJUST_ASPECT_RATIO)
+    {
+        hh = hh * 6 / 5 + 1;
+    }
+    if (automap_rotate)
+    {
+        hw = hh = hw + hh;
+    }
+
+    x1 = (m_x + m_w / 2 - hw - min_x) / grid_cellw;
+    x2 = (m_x + m_w / 2 + hw - min_x) / grid_cellw;
+    y1 = (m_y + m_h / 2 - hh - min_y) / grid_cellh;
+    y2 = (m_y + m_h / 2 + hh - min_y) / grid_cellh;
+
+    if (x1 <= 0 && y1 <= 0 && x2 >= AM_GRIDCELLS - 1 && y2 >= AM_GRIDCELLS - 1)
+    {
+        return true;
+    }
+
+    ++line_stampnum;
+
+    x1 = MAX(x1, 0); x2 = MIN(x2, AM_GRIDCELLS - 1);
+    y1 = MAX(y1, 0); y2 = MIN(y2, AM_GRIDCELLS - 1);
+
+    for (int y = y1; y <= y2; y++)
+    {
+        for (int x = x1; x <= x2; x++)
+        {
+            const int c = y * AM_GRIDCELLS + x;
+
+            for (int j = grid_first[c]; j < grid_first[c + 1]; j++)
+            {
+                line_stamp[grid_lines[j]] = line_stampnum;
+            }
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// AM_transformVertexes
+//  [JN] Keeps every vertex in map coordinates with AM_transformPoint
+//  applied. They only have to be transformed again when the rotation,
+//  its center or the aspect ratio correction changes.
+// -----------------------------------------------------------------------------
+
+static void AM_transformVertexes (void)
+{
+    static boolean old_rotate, old_aspect;
+    static angle_t old_angle;
+    static mpoint_t old_center;
+    const boolean rotate = automap_rotate;
+    const boolean aspect = ADJUST_ASPECT_RATIO;
+    const angle_t angle = rotate ? AM_rotationAngle() : 0;
+    const mpoint_t center = (rotate || aspect) ? mapcenter : (mpoint_t){0, 0};
+
+    if (am_vertexes_valid && rotate == old_rotate && aspect == old_aspect
+    &&  angle == old_angle && center.x == old_center.x && center.y == old_center.y)
+    {
+        return;
+    }
+
+    for (int i = 0; i < numvertexes; i++)
+    {
+        am_vertexes[i].x = vertexes[i].x >> FRACTOMAPBITS;
+        am_vertexes[i].y = vertexes[i].y >> FRACTOMAPBITS;
+        AM_transformPoint(&am_vertexes[i]);
+    }
+
+    am_vertexes_valid = true;
+    old_rotate = rotate;
+    old_aspect = aspect;
+    old_angle = angle;
+    old_center = center;
+}
+
 // -----------------------------------------------------------------------------
 // AM_changeWindowLoc
 //  [PN] Moves the map window by the global variables m_paninc.x, m_paninc.y
@@ -560,6 +735,7 @@ void AM_LevelInit (boolean reinit)
     AM_SetdrawFline();
 
     AM_findMinMaxBoundaries();
+    AM_initLineGrid();
 
     // [crispy] preserve map scale when re-initializing
     if (reinit && f_h_old)
@@ -1317,6 +1493,41 @@ static void AM_drawFline_Vanilla (fline_t *fl, int color)
         return;
     }
 
+    // [JN] Thin lines: walk a pointer through the frame buffer.
+    if (!automap_thick)
+    {
+        const pixel_t c = automap_smooth ? (pixel_t)color : palette_pointer[color];
+        const int px = sx * (flipscreenwidth[1] - flipscreenwidth[0]);
+        const int py = sy * f_w;
+        pixel_t *restrict p = fb + y * f_w + flipscreenwidth[x];
+
+        if (ax > ay) // X-major case
+        {
+            d = ay - ax / 2;
+            for (int n = ax / 2; n > 0; n--)
+            {
+                *p = c;
+                if (d >= 0) { p += py; d -= ax; }
+                p += px;
+                d += ay;
+            }
+        }
+        else // Y-major case
+        {
+            d = ax - ay / 2;
+            for (int n = ay / 2; n > 0; n--)
+            {
+                *p = c;
+                if (d >= 0) { p += px; d -= ay; }
+                p += py;
+                d += ax;
+            }
+        }
+
+        *p = c; // Final point
+        return;
+    }
+
     // [PN] Main loop for Bresenham's line algorithm
     if (ax > ay) // X-major case
     {
@@ -1351,6 +1562,95 @@ static void AM_drawFline_Vanilla (fline_t *fl, int color)
 // reducing redundant calculations, and consolidating variable usage.
 // -----------------------------------------------------------------------------
 
+// -----------------------------------------------------------------------------
+// AM_drawFline_SmoothThin
+// [JN] AM_drawFline_Smooth for thin lines. The same Wu stepping, but it
+// walks a pointer through the frame buffer instead of plotting by x and y.
+// -----------------------------------------------------------------------------
+
+static void AM_drawFline_SmoothThin (const fline_t *fl, const pixel_t *BaseColor)
+{
+    int X0 = fl->a.x, Y0 = fl->a.y, X1 = fl->b.x, Y1 = fl->b.y;
+    unsigned short ErrorAcc = 0, ErrorAdj, ErrorAccTemp, Weighting;
+    const unsigned short WeightingComplementMask = NUMSHADES - 1;
+    const short IntensityShift = 16 - NUMSHADES_BITS;
+    int DeltaX, DeltaY, XDir;
+
+    /* Ensure the line runs top to bottom */
+    if (Y0 > Y1)
+    {
+        int temp = Y0; Y0 = Y1; Y1 = temp;
+        temp = X0; X0 = X1; X1 = temp;
+    }
+
+    DeltaX = X1 - X0;
+    DeltaY = Y1 - Y0;
+    XDir = (DeltaX >= 0) ? 1 : -1;
+    DeltaX = (DeltaX >= 0) ? DeltaX : -DeltaX;
+
+    const int px = XDir * (flipscreenwidth[1] - flipscreenwidth[0]);
+    const int py = f_w;
+    pixel_t *restrict p = fb + Y0 * f_w + flipscreenwidth[X0];
+
+    /* Draw the initial pixel */
+    *p = BaseColor[0];
+
+    /* Horizontal, vertical and diagonal lines */
+    if (DeltaY == 0 || DeltaX == 0 || DeltaX == DeltaY)
+    {
+        const int step = (DeltaX ? px : 0) + (DeltaY ? py : 0);
+
+        for (int n = MAX(DeltaX, DeltaY); n > 0; n--)
+        {
+            p += step;
+            *p = BaseColor[0];
+        }
+        return;
+    }
+
+    /* Y-major line */
+    if (DeltaY > DeltaX)
+    {
+        ErrorAdj = ((unsigned int)DeltaX << 16) / (unsigned int)DeltaY;
+
+        while (--DeltaY)
+        {
+            ErrorAccTemp = ErrorAcc;
+            ErrorAcc += ErrorAdj;
+            if (ErrorAcc <= ErrorAccTemp)
+            {
+                p += px;
+            }
+            p += py;
+            Weighting = ErrorAcc >> IntensityShift;
+            p[0] = BaseColor[Weighting];
+            p[px] = BaseColor[Weighting ^ WeightingComplementMask];
+        }
+    }
+    /* X-major line */
+    else
+    {
+        ErrorAdj = ((unsigned int)DeltaY << 16) / (unsigned int)DeltaX;
+
+        while (--DeltaX)
+        {
+            ErrorAccTemp = ErrorAcc;
+            ErrorAcc += ErrorAdj;
+            if (ErrorAcc <= ErrorAccTemp)
+            {
+                p += py;
+            }
+            p += px;
+            Weighting = ErrorAcc >> IntensityShift;
+            p[0] = BaseColor[Weighting];
+            p[py] = BaseColor[Weighting ^ WeightingComplementMask];
+        }
+    }
+
+    /* Draw the final pixel */
+    PUTDOT_RAW(X1, Y1, BaseColor[0]);
+}
+
 static void AM_drawFline_Smooth(fline_t* fl, int color)
 {
     int X0 = fl->a.x, Y0 = fl->a.y, X1 = fl->b.x, Y1 = fl->b.y;
@@ -1360,6 +1660,12 @@ static void AM_drawFline_Smooth(fline_t* fl, int color)
     // [PN] Declared IntensityShift with other variables
     short DeltaX, DeltaY, XDir, IntensityShift = 16 - NUMSHADES_BITS;
 
+    if (!automap_thick)
+    {
+        AM_drawFline_SmoothThin(fl, BaseColor);
+        return;
+    }
+
     /* Ensure the line runs top to bottom */
     if (Y0 > Y1)
     {
@@ -1542,15 +1848,20 @@ static void AM_drawGrid (void)
 static void AM_drawWalls (void)
 {
     static mline_t l;
+    const boolean allcells = AM_markVisibleLines();
+
+    AM_transformVertexes();
 
     for (int i = 0 ; i < numlines ; i++)
     {
-        l.a.x = lines[i].v1->x >> FRACTOMAPBITS;
-        l.a.y = lines[i].v1->y >> FRACTOMAPBITS;
-        l.b.x = lines[i].v2->x >> FRACTOMAPBITS;
-        l.b.y = lines[i].v2->y >> FRACTOMAPBITS;
-        AM_transformPoint(&l.a);
-        AM_transformPoint(&l.b);
+        // [JN] Skip lines outside of the grid cells in view.
+        if (!allcells && line_stamp[i] != line_stampnum)
+        {
+            continue;
+        }
+
+        l.a = am_vertexes[lines[i].v1 - vertexes];
+        l.b = am_vertexes[lines[i].v2 - vertexes];
 
         if (iddt_cheating || (lines[i].flags & ML_MAPPED))
         {
@@ -1708,7 +2019,7 @@ static void AM_transformPoint(mpoint_t *pt)
     if (automap_rotate)
     {
         int64_t tmpx, tmpy;
-        angle_t angle = (followplayer || !automap_overlay ? ANG90 - viewangle : mapangle) >> ANGLETOFINESHIFT;
+        angle_t angle = AM_rotationAngle() >> ANGLETOFINESHIFT;
 
         pt->x -= mapcenter.x;
         pt->y -= mapcenter.y;
@@ -2070,6 +2381,9 @@ void AM_Drawer (void)
     {
         return;
     }
+
+    // [JN] The map is drawn right into the screen buffer.
+    V_MarkRect(f_x, f_y, f_w, f_h);
     
     // [JN] Moved from AM_Ticker for drawing interpolation.
     if (followplayer)
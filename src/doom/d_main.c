@@ -84,6 +84,12 @@ boolean advancedemo;
 
 static int   pagetic;
 
+// [JN] Patches drawn every frame on the demo screen.
+static lumphandle_t lump_title   = LUMPHANDLE("M_TITLE");
+static lumphandle_t lump_credits = LUMPHANDLE("CREDITS");
+static lumphandle_t lump_page    = LUMPHANDLE("TITLE");
+static lumphandle_t lump_paused  = LUMPHANDLE("PAUSED");
+
 // If true, the main game loop has started.
 boolean main_loop_started = false;
 
@@ -161,6 +167,24 @@ static void ID_DrawMessageCentered (void)
     M_WriteTextCentered(63, player->messageCentered, player->messageCenteredColor);
 }
 
+// -----------------------------------------------------------------------------
+// D_SampleInput
+//  [JN] Read the mouse and apply it to the view for uncapped rendering.
+// -----------------------------------------------------------------------------
+
+static void D_SampleInput (void)
+{
+    I_UpdateFracTic();
+
+    // [JN] Prevent player rotation while automap panning by mouse.
+    if (!automapactive || !automap_mouse_pan || followplayer)
+    {
+        I_StartDisplay();
+        G_FastResponder();
+        G_PrepTiccmd();
+    }
+}
+
 // -----------------------------------------------------------------------------
 // D_Display
 //  draw current display, possibly wiping it from the previous
@@ -189,23 +213,25 @@ static void D_Display (void)
         post_rendering_hook = NULL;
     }
 
-    if (vid_uncapped_fps)
-    {
-        I_UpdateFracTic();
+    // [JN] With vid_late_input, the view is drawn with the input read
+    // right before it, see below.
+    const boolean late_input = vid_uncapped_fps && vid_late_input
+                            && gamestate == GS_LEVEL && gametic;
 
-        // [JN] Prevent player rotation while automap panning by mouse.
-        if (!automapactive || !automap_mouse_pan || followplayer)
-        {
-            I_StartDisplay();
-            G_FastResponder();
-            G_PrepTiccmd();
-        }
+    if (vid_uncapped_fps && !late_input)
+    {
+        D_SampleInput();
     }
 
     // change the view size if needed
+    // [JN] The tables for the new size are built in the background,
+    // the view keeps its old size until they are ready.
     if (setsizeneeded)
     {
-        R_ExecuteSetViewSize();
+        R_QueueSetViewSize();
+    }
+    if (R_SwapViewSize())
+    {
         oldgamestate = -1;  // force background redraw
     }
 
@@ -228,6 +254,9 @@ static void D_Display (void)
             if (!gametic)
             break;
 
+            if (late_input)
+            D_SampleInput();
+
             // draw the view directly
             R_RenderPlayerView(&players[displayplayer]);
 
@@ -295,11 +324,11 @@ static void D_Display (void)
 		// [JN] Jaguar: always show white background on demo screen.
 		// Swap big Doom logo with credits screen every 10 seconds,
 		// but don't draw them while active menu.
-        V_DrawPatchFullScreen(W_CacheLumpName("M_TITLE", PU_CACHE), false);
+        V_DrawPatchFullScreen(W_CacheLumpHandle(&lump_title, PU_CACHE), false);
         if (!menuactive)
 		{
-			V_DrawPatch(0, 0, W_CacheLumpName((pagetic < 10 * TICRATE ?
-			                                   "CREDITS" : "TITLE"), PU_CACHE));
+			V_DrawPatch(0, 0, W_CacheLumpHandle((pagetic < 10 * TICRATE ?
+			                                     &lump_credits : &lump_page), PU_CACHE));
 		}
         break;
     }
@@ -313,7 +342,7 @@ static void D_Display (void)
     // draw pause pic
     if (paused)
     {
-		V_DrawShadowedPatchOptional(136, 72, W_CacheLumpName ("PAUSED", PU_CACHE));
+		V_DrawShadowedPatchOptional(136, 72, W_CacheLumpHandle(&lump_paused, PU_CACHE));
     }
 
     // [JN] Draw right widgets in any states except finale text screens.
@@ -433,6 +462,7 @@ void D_DoomLoop (void)
     I_SetWindowTitle("CRY");
     I_GraphicsCheckCommandLine();
     I_SetGrabMouseCallback(D_GrabMouseCallback);
+    I_SetVideoBufferCallback(R_RelocateBuffer);
     I_RegisterWindowIcon(doom_data, doom_w, doom_h);
     I_InitGraphics();
 
@@ -466,6 +496,9 @@ void D_DoomLoop (void)
             S_UpdateSounds (players[displayplayer].mo);
             oldgametic = gametic;
         }
+
+        // [JN] Move positional sounds along with interpolated view.
+        S_UpdateSoundsFrame (players[displayplayer].mo);
     }
 }
 
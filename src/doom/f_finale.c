@@ -27,6 +27,7 @@
 #include "r_local.h"
 #include "s_sound.h"
 #include "v_video.h"
+#include "w_wad.h"
 #include "z_zone.h"
 
 #include "id_func.h"
@@ -62,6 +63,9 @@ static finalestage_t finalestage;
 static unsigned int finalecount;
 static unsigned int finaleendcount;
 
+// [JN] Background, drawn every frame.
+static lumphandle_t lump_title = LUMPHANDLE("M_TITLE");
+
 static void F_StartCast (void);
 static void F_CastTicker (void);
 static void F_CastDrawer (void);
@@ -200,7 +204,7 @@ static void F_TextWrite (void)
 	signed int  count;
 	const char *ch;
 
-    V_DrawPatchFullScreen(W_CacheLumpName(("M_TITLE"), PU_CACHE), false);
+    V_DrawPatchFullScreen(W_CacheLumpHandle(&lump_title, PU_CACHE), false);
 
 	// draw some of the text onto the screen
 	cx = 10;
@@ -407,7 +411,7 @@ static boolean F_CastResponder (const event_t *ev)
 static void F_CastDrawer (void)
 {
 	// erase the entire screen to a background
-	V_DrawPatchFullScreen(W_CacheLumpName("M_TITLE", PU_CACHE), false);
+	V_DrawPatchFullScreen(W_CacheLumpHandle(&lump_title, PU_CACHE), false);
 
 	// [JN] Simplify to use common text drawing function.
 	M_WriteTextBigCentered(15, castorder[castnum].name, NULL);
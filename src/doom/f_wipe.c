@@ -336,13 +336,18 @@ boolean wipe_ScreenWipe (const int ticks)
     }
 
     // initial stuff
+    // [JN] The screen buffer may move between frames.
+    wipe_scr = I_VideoBuffer;
+
     if (!go)
     {
         go = true;
-        wipe_scr = I_VideoBuffer;
         wipe_init();
     }
 
+    // [JN] Wipes write right into the screen buffer.
+    V_MarkScreen();
+
     // final stuff
     if ((*wipe_do)(ticks))
     {
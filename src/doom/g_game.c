@@ -27,6 +27,7 @@
 #include "doomkeys.h"
 #include "doomstat.h"
 
+#include "z_stats.h"
 #include "z_zone.h"
 #include "f_finale.h"
 #include "m_argv.h"
@@ -1304,6 +1305,9 @@ void G_Ticker (void)
     // Tics can't go negative.
     CT_Ticker();
 
+    // [JN] Per tic zone memory counters.
+    Z_StatsTic();
+
     //
     // [JN] Query time for time-related widgets:
     //
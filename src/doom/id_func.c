@@ -22,9 +22,11 @@
 #include "v_trans.h"
 #include "v_video.h"
 #include "doomstat.h"
+#include "i_timer.h"
 #include "m_menu.h"
 #include "m_misc.h"
 #include "p_local.h"
+#include "z_stats.h"
 
 #include "id_vars.h"
 #include "id_func.h"
@@ -152,6 +154,45 @@ static void ID_WidgetKISCount (char *buffer, size_t buffer_size, const int i)
     }
 }
 
+// -----------------------------------------------------------------------------
+// ID_DrawZoneCounters.
+//  [JN] Zone memory counters, drawn to the right of the render counters:
+//  used/total zone size, largest free block, allocations and purges
+//  of cached blocks during the last tic.
+// -----------------------------------------------------------------------------
+
+static void ID_DrawZoneCounters (const int x, const int y)
+{
+    // Z_LargestFree walks the whole zone, only do that once a second.
+    static int largest_free, largest_free_time = -TICRATE;
+    const int time = I_GetTime();
+    char str[32];
+
+    if (time - largest_free_time >= TICRATE)
+    {
+        largest_free = Z_LargestFree();
+        largest_free_time = time;
+    }
+
+    M_WriteText(x, y, "ZON:", cr[CR_GRAY]);
+    M_snprintf(str, sizeof(str), "%dK/%dK",
+               zonestats.live_total >> 10, (int) (Z_ZoneSize() >> 10));
+    M_WriteText(x + 32, y, str, cr[CR_GREEN]);
+
+    M_WriteText(x, y + 9, "FRE:", cr[CR_GRAY]);
+    M_snprintf(str, sizeof(str), "%dK", largest_free >> 10);
+    M_WriteText(x + 32, y + 9, str, cr[CR_GREEN]);
+
+    M_WriteText(x, y + 18, "ALC:", cr[CR_GRAY]);
+    M_snprintf(str, sizeof(str), "%d", zonestats.tic_allocs);
+    M_WriteText(x + 32, y + 18, str, cr[CR_GREEN]);
+
+    M_WriteText(x, y + 27, "PRG:", cr[CR_GRAY]);
+    M_snprintf(str, sizeof(str), "%d", zonestats.tic_purges);
+    M_WriteText(x + 32, y + 27, str,
+                zonestats.tic_purges ? cr[CR_YELLOW] : cr[CR_GREEN]);
+}
+
 // -----------------------------------------------------------------------------
 // ID_LeftWidgets.
 //  [JN] Draw all the widgets and counters.
@@ -262,6 +303,12 @@ void ID_LeftWidgets (void)
             M_WriteText(left_align, 138, "PLN:", cr[CR_GRAY]);
             M_snprintf(vis, 32, "%d", IDRender.numplanes);
             M_WriteText(32 + left_align, 138, vis, cr[CR_GREEN]);
+
+            // Zone memory
+            if (widget_render == 2)
+            {
+                ID_DrawZoneCounters(80 + left_align, 111);
+            }
         }
     }
     //
@@ -305,6 +352,12 @@ void ID_LeftWidgets (void)
             M_WriteText(left_align, 73 + yy1, "PLN:", cr[CR_GRAY]);
             M_snprintf(vis, 32, "%d", IDRender.numplanes);
             M_WriteText(32 + left_align, 73 + yy1, vis, cr[CR_GREEN]);
+
+            // Zone memory
+            if (widget_render == 2)
+            {
+                ID_DrawZoneCounters(80 + left_align, 46 + yy1);
+            }
         }
 
         // Player coords
@@ -204,8 +204,23 @@ static short skullAnimCounter;  // skull animation counter
 static short whichSkull;        // which skull to draw
 
 // graphic name of skulls
-// warning: initializer-string for array of chars is too long
-static char *skullName[2] = {"M_SKULL1","M_SKULL2"};
+// [JN] Kept as lump handles, these and the patches below are drawn
+// every frame while the menu is active.
+static lumphandle_t skullName[2] = {LUMPHANDLE("M_SKULL1"), LUMPHANDLE("M_SKULL2")};
+
+static lumphandle_t lump_floor4_8 = LUMPHANDLE("FLOOR4_8");
+static lumphandle_t lump_lsleft   = LUMPHANDLE("M_LSLEFT");
+static lumphandle_t lump_lscntr   = LUMPHANDLE("M_LSCNTR");
+static lumphandle_t lump_lsrght   = LUMPHANDLE("M_LSRGHT");
+static lumphandle_t lump_title    = LUMPHANDLE("M_TITLE");
+static lumphandle_t lump_help     = LUMPHANDLE("HELP");
+static lumphandle_t lump_doom     = LUMPHANDLE("M_DOOM");
+static lumphandle_t lump_nmare    = LUMPHANDLE("M_NMARE");
+static lumphandle_t lump_therml   = LUMPHANDLE("M_THERML");
+static lumphandle_t lump_thermm   = LUMPHANDLE("M_THERMM");
+static lumphandle_t lump_thermr   = LUMPHANDLE("M_THERMR");
+static lumphandle_t lump_thermo   = LUMPHANDLE("M_THERMO");
+static lumphandle_t lump_defaults = LUMPHANDLE("DEFAULTS");
 
 // current menudef
 static menu_t *currentMenu;
@@ -821,6 +836,8 @@ static void M_ShadeBackground (void)
         pixel_t *dest = I_VideoBuffer;
         const int shade = dp_menu_shading;
         const int scr = SCREENAREA;
+
+        V_MarkScreen();
         
         for (int i = 0; i < scr; i++)
         {
@@ -832,7 +849,7 @@ static void M_ShadeBackground (void)
 
 static void M_FillBackground (void)
 {
-    const byte *src = W_CacheLumpName("FLOOR4_8", PU_CACHE);
+    const byte *src = W_CacheLumpHandle(&lump_floor4_8, PU_CACHE);
     pixel_t *dest = I_VideoBuffer;
 
     V_FillFlat(0, SCREENHEIGHT, 0, SCREENWIDTH, src, dest);
@@ -1230,11 +1247,6 @@ static void M_ID_ShowFPS (int choice)
 static void M_ID_PixelScaling (int choice)
 {
     vid_smooth_scaling ^= 1;
-
-    // [crispy] re-calculate the zlight[][] array
-    R_InitLightTables();
-    // [crispy] re-calculate the scalelight[][] array
-    R_ExecuteSetViewSize();
 }
 
 static void M_ID_ScreenWipe (int choice)
@@ -1532,10 +1544,8 @@ static void M_ID_Gamma (int choice)
     shade_wait = I_GetTime() + TICRATE;
     vid_gamma = M_INT_Slider(vid_gamma, 0, MAXGAMMA-1, choice, true);
 
+    // [JN] Gamma is applied by I_FinishUpdate, nothing to rebuild.
     I_SetPalette(st_palette);
-    R_InitColormaps();
-    R_FillBackScreen();
-    st_fullupdate = true;
 }
 
 static void M_ID_CRYPalette (int choice)
@@ -1551,10 +1561,9 @@ static void M_ID_FOV (int choice)
 {
     vid_fov = M_INT_Slider(vid_fov, 45, 135, choice, true);
 
-    // [crispy] re-calculate the zlight[][] array
-    R_InitLightTables();
-    // [crispy] re-calculate the scalelight[][] array
-    R_ExecuteSetViewSize();
+    // [JN] The zlight[][] array doesn't depend on FOV, the view tables
+    // are built in the background and swapped in by D_Display.
+    setsizeneeded = true;
 }
 
 static void M_ID_MenuShading (int choice)
@@ -2844,7 +2853,8 @@ static void M_Draw_ID_Widgets (void)
                                 LINE_ALPHA(8));
 
     // Rendering counters
-    sprintf(str, widget_render ? "ON" : "OFF");
+    sprintf(str, widget_render == 1 ? "ON"      :
+                 widget_render == 2 ? "ON+ZONE" : "OFF");
     M_WriteTextGlow(M_ItemRightAlign(str), 99, str,
                         widget_render ? cr[CR_GREEN] : cr[CR_DARKRED],
                             widget_render ? cr[CR_GREEN_BRIGHT] : cr[CR_RED_BRIGHT],
@@ -2909,7 +2919,7 @@ static void M_ID_Widget_Coords (int choice)
 
 static void M_ID_Widget_Render (int choice)
 {
-    widget_render ^= 1;
+    widget_render = M_INT_Slider(widget_render, 0, 2, choice, false);
 }
 
 static void M_ID_Widget_Health (int choice)
@@ -3204,16 +3214,10 @@ static void M_ID_Brightmaps (int choice)
 static void M_ID_ColoredLightingHook (void)
 {
     vis_colored_lighting ^= 1;
-    
-    if (!vis_colored_lighting)
-    {
-        R_FreeColoredLights();
-    }
-    else
-    {
-        R_InitColoredLightTables();
-    }
-    R_ExecuteSetViewSize();
+
+    // [JN] Colored tables are generated when used,
+    // nothing else depends on the setting.
+    R_FreeColoredLights();
 }
 
 static void M_ID_ColoredLighting (int choice)
@@ -3966,16 +3970,17 @@ static void M_DrawLoad(void)
 static void M_DrawSaveLoadBorder(int x,int y)
 {
     int             i;
+    patch_t        *center = W_CacheLumpHandle(&lump_lscntr, PU_CACHE);
 	
-    V_DrawShadowedPatchOptional(x - 8, y, W_CacheLumpName("M_LSLEFT", PU_CACHE));
+    V_DrawShadowedPatchOptional(x - 8, y, W_CacheLumpHandle(&lump_lsleft, PU_CACHE));
 	
     for (i = 0;i < 24;i++)
     {
-	V_DrawShadowedPatchOptional(x, y, W_CacheLumpName("M_LSCNTR", PU_CACHE));
+	V_DrawShadowedPatchOptional(x, y, center);
 	x += 8;
     }
 
-    V_DrawShadowedPatchOptional(x, y, W_CacheLumpName("M_LSRGHT", PU_CACHE));
+    V_DrawShadowedPatchOptional(x, y, W_CacheLumpHandle(&lump_lsrght, PU_CACHE));
 }
 
 
@@ -4197,8 +4202,8 @@ static void M_DrawHelp (void)
 {
     st_fullupdate = true;
 
-    V_DrawPatchFullScreen(W_CacheLumpName("M_TITLE", PU_CACHE), false);
-    V_DrawShadowedPatchOptional(0, 0, W_CacheLumpName("HELP", PU_CACHE));
+    V_DrawPatchFullScreen(W_CacheLumpHandle(&lump_title, PU_CACHE), false);
+    V_DrawShadowedPatchOptional(0, 0, W_CacheLumpHandle(&lump_help, PU_CACHE));
 }
 
 
@@ -4270,7 +4275,7 @@ static void M_MusicVol(int choice)
 //
 static void M_DrawMainMenu(void)
 {
-    V_DrawPatch(94, 2, W_CacheLumpName("M_DOOM", PU_CACHE));
+    V_DrawPatch(94, 2, W_CacheLumpHandle(&lump_doom, PU_CACHE));
 }
 
 
@@ -4285,10 +4290,10 @@ static void M_DrawNewGame (void)
 	M_WriteTextBigCentered(38, "Difficulty:", NULL);
 	// [JN] Jaguar: draw "Nightmare!" as separated patches.
     // Base patch
-    V_DrawShadowedPatchOptional(69, 127, W_CacheLumpName("M_NMARE", PU_CACHE));
+    V_DrawShadowedPatchOptional(69, 127, W_CacheLumpHandle(&lump_nmare, PU_CACHE));
     // Glowing overlay
     dp_translation = currentMenu->menuitems[4].tics > 0 ? cr[CR_MENU_BRIGHT3] : NULL;
-    V_DrawFadePatch(69, 127, W_CacheLumpName("M_NMARE", PU_CACHE), LINE_ALPHA(4));
+    V_DrawFadePatch(69, 127, W_CacheLumpHandle(&lump_nmare, PU_CACHE), LINE_ALPHA(4));
 	dp_translation = NULL;
 }
 
@@ -4456,6 +4461,7 @@ M_DrawThermo
 {
     int		xx;
     int		i;
+    patch_t    *middle;
 
     // [JN] Highlight active slider and gem.
     if (itemPos == itemOn)
@@ -4464,14 +4470,15 @@ M_DrawThermo
     }
 
     xx = x;
-    V_DrawShadowedPatchOptional(xx, y, W_CacheLumpName("M_THERML", PU_CACHE));
+    V_DrawShadowedPatchOptional(xx, y, W_CacheLumpHandle(&lump_therml, PU_CACHE));
     xx += 8;
+    middle = W_CacheLumpHandle(&lump_thermm, PU_CACHE);
     for (i=0;i<thermWidth;i++)
     {
-	V_DrawShadowedPatchOptional(xx, y, W_CacheLumpName("M_THERMM", PU_CACHE));
+	V_DrawShadowedPatchOptional(xx, y, middle);
 	xx += 8;
     }
-    V_DrawShadowedPatchOptional(xx, y, W_CacheLumpName("M_THERMR", PU_CACHE));
+    V_DrawShadowedPatchOptional(xx, y, W_CacheLumpHandle(&lump_thermr, PU_CACHE));
 
     // [crispy] do not crash anymore if value exceeds thermometer range
     if (thermDot >= thermWidth)
@@ -4479,7 +4486,7 @@ M_DrawThermo
         thermDot = thermWidth - 1;
     }
 
-    V_DrawPatch((x + 8) + thermDot * 8, y, W_CacheLumpName("M_THERMO", PU_CACHE));
+    V_DrawPatch((x + 8) + thermDot * 8, y, W_CacheLumpHandle(&lump_thermo, PU_CACHE));
 
     dp_translation = NULL;
 }
@@ -5539,9 +5546,6 @@ boolean M_Responder (event_t* ev)
         vid_gamma = M_INT_Slider(vid_gamma, 0, MAXGAMMA-1, 1 /*right*/, false);
         CT_SetMessage(&players[consoleplayer], gammalvls[vid_gamma][0], true, NULL);
         I_SetPalette(st_palette);
-        R_InitColormaps();
-        R_FillBackScreen();
-        st_fullupdate = true;
         return true;
     }
 
@@ -5955,7 +5959,7 @@ void M_Drawer (void)
         // DRAW SKULL
         if (itemOn != -1)
         V_DrawShadowedPatchOptional(x + SKULLXOFF, y - 5 + itemOn * LINEHEIGHT,
-                                    W_CacheLumpName(skullName[whichSkull], PU_CACHE));
+                                    W_CacheLumpHandle(&skullName[whichSkull], PU_CACHE));
 
         for (i = 0 ; i < max ; i++)
         {
@@ -5973,7 +5977,7 @@ void M_Drawer (void)
     // [JN] Draw "Defaults Restored" plaque while it's timer is active.
     if (resetplaque_tics)
     {
-        V_DrawShadowedPatchOptional(116, 76, W_CacheLumpName("DEFAULTS", PU_CACHE));
+        V_DrawShadowedPatchOptional(116, 76, W_CacheLumpHandle(&lump_defaults, PU_CACHE));
     }
 
     // [JN] Call the menu control routine for mouse input.
@@ -48,6 +48,7 @@ result_e	T_MovePlane(sector_t *sector,fixed_t speed,
         sector->oldfloorheight = sector->floorheight;
         sector->oldceilingheight = sector->ceilingheight;
         sector->oldgametic = gametic;
+        R_AddInterpSector(sector);
     }
 
 	switch(floorOrCeiling)
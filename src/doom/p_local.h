@@ -653,6 +653,7 @@ extern int st_keyorskull[3];
 
 extern void P_SegLengths (boolean contrast_only);
 extern void P_SetupLevel (int episode, int map);
+extern void P_PrefetchLevel (int map);
 extern void P_Init (void);
 
 extern byte     *rejectmatrix;  // for fast sight rejection
@@ -1607,6 +1607,9 @@ void P_UnArchiveWorld (void)
 	short floorpic, ceilingpic;
 	sec->floorheight = saveg_read16() << FRACBITS;
 	sec->ceilingheight = saveg_read16() << FRACBITS;
+	// [JN] Not interpolated until moved again, see R_InterpolateSectors.
+	sec->interpfloorheight = sec->floorheight;
+	sec->interpceilingheight = sec->ceilingheight;
 	floorpic = saveg_read16();
 	ceilingpic = saveg_read16();
 	sec->lightlevel = saveg_read16();
@@ -414,7 +414,7 @@ static void P_PrepareSectorColors(int gamemap, const sectorcolor_t *colors, int
         &&  colors[j].color != 0)
         {
             // [PN] Assign the color to the corresponding sector
-            color_for_sector[colors[j].sector] = colors[j].color;
+            color_for_sector[colors[j].sector] = R_ColoredLightIndex(colors[j].color);
         }
     }
 }
@@ -438,6 +438,7 @@ static void P_LoadSectors (int lump)
     sector_t *const dst = Z_Malloc((size_t)count * sizeof(*dst), PU_LEVEL, 0);
     memset(dst, 0, (size_t)count * sizeof(*dst));
     sectors = dst;
+    R_ClearInterpSectors();
 
     // Load raw sector data into cache
     const byte *const data = W_CacheLumpNum(lump, PU_STATIC);
@@ -1137,6 +1138,31 @@ static void P_LoadReject (int lumpnum)
 // P_SetupLevel
 // -----------------------------------------------------------------------------
 
+// -----------------------------------------------------------------------------
+// P_PrefetchLevel
+// [JN] Start reading the map lumps of the given level in the background,
+//      so that loading them later doesn't wait on page faults.
+// -----------------------------------------------------------------------------
+
+void P_PrefetchLevel (int map)
+{
+    char lumpname[9];
+
+    snprintf(lumpname, 9, "MAP%02d", map);
+
+    const int lumpnum = W_CheckNumForName(lumpname);
+
+    if (lumpnum < 0)
+    {
+        return;
+    }
+
+    for (int i = ML_THINGS; i <= ML_BLOCKMAP; ++i)
+    {
+        W_PrefetchLumpNum(lumpnum + i);
+    }
+}
+
 void P_SetupLevel (int episode, int map)
 {
     char	lumpname[9];
@@ -1165,13 +1191,17 @@ void P_SetupLevel (int episode, int map)
     snprintf(lumpname, 9, "MAP%02d", map);
 
     const int lumpnum = W_GetNumForName(lumpname);
+
+    P_PrefetchLevel(map);
 	
     // [JN] Check for modified map to allow injection of colored lighting.
     // Adaptaken from DOOM Retro, thanks Brad Harding!
     canmodify = W_CheckMultipleLumps(lumpname) == 1;
 
-    // [JN] Set per-level sector colors table.
+    // [JN] Set per-level sector colors table. Only the colors
+    // used in this level will have their tables generated.
     P_SetSectorColorTable(map);
+    R_FreeColoredLights();
 
     // Reset timers
     leveltime = realleveltime = oldleveltime = 0;
@@ -1184,6 +1214,9 @@ void P_SetupLevel (int episode, int map)
     P_LoadVertexes(lumpnum + ML_VERTEXES);
     P_LoadSectors(lumpnum + ML_SECTORS);
     P_LoadSideDefs(lumpnum + ML_SIDEDEFS);
+    // [JN] Let the disk read the level's graphics while the rest is loaded.
+    if (precache)
+        R_PrefetchLevel();
     P_LoadLineDefs(lumpnum + ML_LINEDEFS);
     // [crispy] (re-)create BLOCKMAP if necessary
     if (!crispy_validblockmap)
@@ -202,6 +202,7 @@ void R_ClearClipSegs (void)
 // -----------------------------------------------------------------------------
 // R_MaybeInterpolateSector
 // [AM] Interpolate the passed sector, if prudent.
+// [JN] Only called for the sectors moved by thinkers, see below.
 // -----------------------------------------------------------------------------
 
 static void R_MaybeInterpolateSector(sector_t* sector)
@@ -239,6 +240,64 @@ static void R_MaybeInterpolateSector(sector_t* sector)
     }
 }
 
+// -----------------------------------------------------------------------------
+// Sector interpolation list
+//  [JN] T_MovePlane lists the sectors it moves, and only these are
+//  interpolated, once per frame before the BSP walk. A sector leaves the
+//  list once it didn't move for a whole tic, with its heights reset.
+//  The interpolated heights of all other sectors are kept equal to the
+//  real ones by whoever sets them.
+// -----------------------------------------------------------------------------
+
+static sector_t **interpsectors;
+static int numinterpsectors;
+static int maxinterpsectors;
+
+void R_AddInterpSector (sector_t *sector)
+{
+    if (sector->interplisted)
+    {
+        return;
+    }
+
+    if (numinterpsectors == maxinterpsectors)
+    {
+        maxinterpsectors = maxinterpsectors ? maxinterpsectors * 2 : 64;
+        interpsectors = I_Realloc(interpsectors, maxinterpsectors * sizeof(*interpsectors));
+    }
+
+    interpsectors[numinterpsectors++] = sector;
+    sector->interplisted = true;
+}
+
+void R_ClearInterpSectors (void)
+{
+    numinterpsectors = 0;
+}
+
+void R_InterpolateSectors (void)
+{
+    int count = 0;
+
+    for (int i = 0; i < numinterpsectors; i++)
+    {
+        sector_t *const sector = interpsectors[i];
+
+        R_MaybeInterpolateSector(sector);
+
+        if (sector->oldgametic >= gametic - 1)
+        {
+            interpsectors[count++] = sector;
+        }
+        else
+        {
+            sector->interplisted = false;
+        }
+    }
+
+    numinterpsectors = count;
+}
+
 // -----------------------------------------------------------------------------
 // R_AddLine
 // Clips the given segment
@@ -316,14 +375,7 @@ static void R_AddLine (seg_t *line)
     backsector = line->backsector;
 
     // Single sided line?
-    if (backsector)
-    {
-        // [AM] Interpolate sector movement before
-        //      running clipping tests.  Frontsector
-        //      should already be interpolated.
-        R_MaybeInterpolateSector(backsector);
-    }
-    else
+    if (!backsector)
     {
         // [JN] If no backsector is present, 
         // just clip the line as a solid segment.
@@ -456,10 +508,6 @@ static void R_Subsector (int num)
 
     frontsector = sub->sector;
 
-    // [AM] Interpolate sector movement.  Usually only needed
-    //      when you're standing inside the sector.
-    R_MaybeInterpolateSector(frontsector);
-
     floorplane = frontsector->interpfloorheight < viewz ?
                  R_FindPlane (frontsector->interpfloorheight,
                               // [crispy] add support for MBF sky tranfers
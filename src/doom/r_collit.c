@@ -17,6 +17,7 @@
 
 #include <stdlib.h>
 
+#include "i_system.h"
 #include "z_zone.h"
 #include "doomstat.h"
 #include "p_local.h"
@@ -31,634 +32,151 @@
 //
 // =============================================================================
 
-// Main colormaps
-static lighttable_t   *colormaps_EEC06B;  // Bright yellow/gold
-static lighttable_t   *colormaps_D97C45;  // Middle yellow/gold (also E29A56)
-static lighttable_t   *colormaps_FF7F7F;  // Bright red
-static lighttable_t   *colormaps_55B828;  // Bright green
-static lighttable_t   *colormaps_BBE357;  // Slime green
-static lighttable_t   *colormaps_949DB9;  // Bright desaturated blue (also 6B779E, 2F2866)
-static lighttable_t   *colormaps_2B3BFF;  // Bright saturated blue
-static lighttable_t   *colormaps_50ADAC;  // Middle cyan (also 31A29F)
-static lighttable_t   *colormaps_CCE4A5;  // Middle green-yellow
-static lighttable_t   *colormaps_CCEA5F;  // Bright green-yellow
-static lighttable_t   *colormaps_B30202;  // Middle red
-static lighttable_t   *colormaps_B87A15;  // Middle orange
-static lighttable_t   *colormaps_FFD000;  // Middle yellow
-static lighttable_t   *colormaps_FFDE4C;  // Middle-bright yellow
-static lighttable_t   *colormaps_FFF588;  // Bright yellow
-static lighttable_t   *colormaps_3089FF;  // Bright cyanic blue (also 043B84)
-static lighttable_t   *colormaps_A88139;  // Middle brown
-static lighttable_t   *colormaps_7084C4;  // Dark cyanic blue 2
-static lighttable_t   *colormaps_D46D3D;  // Middle orange 2
-static lighttable_t   *colormaps_05A8A0;  // Middle saturated cyan
-static lighttable_t   *colormaps_FF3030;  // Bright saturated red
-static lighttable_t   *colormaps_6435B5;  // Un-darked magenta
-static lighttable_t   *colormaps_FFAFAF;  // Brighter red (also FFCECE)
-static lighttable_t   *colormaps_ECB866;  // Bright orange
-static lighttable_t   *colormaps_C63F23;  // Middle orange 3
-static lighttable_t   *colormaps_9BC8CD;  // Bright cyan (also 4F5D8B)
-static lighttable_t   *colormaps_666666;  // Special green (00FF00, overlay 33%)
-static lighttable_t   *colormaps_777777;  // Special red (FF0000, overlay 55%)
-
-// Visplane light tables
-static lighttable_t ***zlight_EEC06B = NULL;
-static lighttable_t ***zlight_D97C45 = NULL;
-static lighttable_t ***zlight_FF7F7F = NULL;
-static lighttable_t ***zlight_55B828 = NULL;
-static lighttable_t ***zlight_BBE357 = NULL;
-static lighttable_t ***zlight_949DB9 = NULL;
-static lighttable_t ***zlight_2B3BFF = NULL;
-static lighttable_t ***zlight_50ADAC = NULL;
-static lighttable_t ***zlight_CCE4A5 = NULL;
-static lighttable_t ***zlight_CCEA5F = NULL;
-static lighttable_t ***zlight_B30202 = NULL;
-static lighttable_t ***zlight_B87A15 = NULL;
-static lighttable_t ***zlight_FFD000 = NULL;
-static lighttable_t ***zlight_FFDE4C = NULL;
-static lighttable_t ***zlight_FFF588 = NULL;
-static lighttable_t ***zlight_3089FF = NULL;
-static lighttable_t ***zlight_A88139 = NULL;
-static lighttable_t ***zlight_7084C4 = NULL;
-static lighttable_t ***zlight_D46D3D = NULL;
-static lighttable_t ***zlight_05A8A0 = NULL;
-static lighttable_t ***zlight_FF3030 = NULL;
-static lighttable_t ***zlight_6435B5 = NULL;
-static lighttable_t ***zlight_FFAFAF = NULL;
-static lighttable_t ***zlight_ECB866 = NULL;
-static lighttable_t ***zlight_C63F23 = NULL;
-static lighttable_t ***zlight_9BC8CD = NULL;
-static lighttable_t ***zlight_666666 = NULL;
-static lighttable_t ***zlight_777777 = NULL;
-
-// Segment/sprite light tables
-static lighttable_t ***scalelight_EEC06B = NULL;
-static lighttable_t ***scalelight_D97C45 = NULL;
-static lighttable_t ***scalelight_FF7F7F = NULL;
-static lighttable_t ***scalelight_55B828 = NULL;
-static lighttable_t ***scalelight_BBE357 = NULL;
-static lighttable_t ***scalelight_949DB9 = NULL;
-static lighttable_t ***scalelight_2B3BFF = NULL;
-static lighttable_t ***scalelight_50ADAC = NULL;
-static lighttable_t ***scalelight_CCE4A5 = NULL;
-static lighttable_t ***scalelight_CCEA5F = NULL;
-static lighttable_t ***scalelight_B30202 = NULL;
-static lighttable_t ***scalelight_B87A15 = NULL;
-static lighttable_t ***scalelight_FFD000 = NULL;
-static lighttable_t ***scalelight_FFDE4C = NULL;
-static lighttable_t ***scalelight_FFF588 = NULL;
-static lighttable_t ***scalelight_3089FF = NULL;
-static lighttable_t ***scalelight_A88139 = NULL;
-static lighttable_t ***scalelight_7084C4 = NULL;
-static lighttable_t ***scalelight_D46D3D = NULL;
-static lighttable_t ***scalelight_05A8A0 = NULL;
-static lighttable_t ***scalelight_FF3030 = NULL;
-static lighttable_t ***scalelight_6435B5 = NULL;
-static lighttable_t ***scalelight_FFAFAF = NULL;
-static lighttable_t ***scalelight_ECB866 = NULL;
-static lighttable_t ***scalelight_C63F23 = NULL;
-static lighttable_t ***scalelight_9BC8CD = NULL;
-static lighttable_t ***scalelight_666666 = NULL;
-static lighttable_t ***scalelight_777777 = NULL;
+// [JN] Sector colors. Sectors refer to them by index, see
+// R_ColoredLightIndex, 0 meaning no color.
+#define NUMCOLLIT 29
 
-// =============================================================================
-//
-//                             COMPOSING FUNCTIONS
-//
-// =============================================================================
-
-void R_AllocateColoredColormaps (void)
+typedef struct
 {
-    const size_t lighttable_size = (NUMCOLORMAPS + 1) * 256 * sizeof(lighttable_t);
-
-    colormaps_EEC06B = malloc(lighttable_size);
-    colormaps_D97C45 = malloc(lighttable_size);
-    colormaps_FF7F7F = malloc(lighttable_size);
-    colormaps_55B828 = malloc(lighttable_size);
-    colormaps_BBE357 = malloc(lighttable_size);
-    colormaps_949DB9 = malloc(lighttable_size);
-    colormaps_2B3BFF = malloc(lighttable_size);
-    colormaps_50ADAC = malloc(lighttable_size);
-    colormaps_CCE4A5 = malloc(lighttable_size);
-    colormaps_CCEA5F = malloc(lighttable_size);
-    colormaps_B30202 = malloc(lighttable_size);
-    colormaps_B87A15 = malloc(lighttable_size);
-    colormaps_FFD000 = malloc(lighttable_size);
-    colormaps_FFDE4C = malloc(lighttable_size);
-    colormaps_FFF588 = malloc(lighttable_size);
-    colormaps_3089FF = malloc(lighttable_size);
-    colormaps_A88139 = malloc(lighttable_size);
-    colormaps_7084C4 = malloc(lighttable_size);
-    colormaps_D46D3D = malloc(lighttable_size);
-    colormaps_05A8A0 = malloc(lighttable_size);
-    colormaps_FF3030 = malloc(lighttable_size);
-    colormaps_6435B5 = malloc(lighttable_size);
-    colormaps_FFAFAF = malloc(lighttable_size);
-    colormaps_ECB866 = malloc(lighttable_size);
-    colormaps_C63F23 = malloc(lighttable_size);
-    colormaps_9BC8CD = malloc(lighttable_size);
-    colormaps_666666 = malloc(lighttable_size);
-    colormaps_777777 = malloc(lighttable_size);
-}
+    int         rgb;
+    const byte *lump_cry;
+    const byte *lump_doom;
+} collitcolor_t;
+
+static const collitcolor_t collit_colors[NUMCOLLIT] = {
+    { 0x000000, NULL,         NULL          },  // No color
+    { 0xEEC06B, C_EEC06B_CRY, C_EEC06B_DOOM },  // Bright yellow/gold
+    { 0xD97C45, C_D97C45_CRY, C_D97C45_DOOM },  // Middle yellow/gold (also E29A56)
+    { 0xFF7F7F, C_FF7F7F_CRY, C_FF7F7F_DOOM },  // Bright red
+    { 0x55B828, C_55B828_CRY, C_55B828_DOOM },  // Bright green
+    { 0xBBE357, C_BBE357_CRY, C_BBE357_DOOM },  // Slime green
+    { 0x949DB9, C_949DB9_CRY, C_949DB9_DOOM },  // Bright desaturated blue (also 6B779E, 2F2866)
+    { 0x2B3BFF, C_2B3BFF_CRY, C_2B3BFF_DOOM },  // Bright saturated blue
+    { 0x50ADAC, C_50ADAC_CRY, C_50ADAC_DOOM },  // Middle cyan (also 31A29F)
+    { 0xCCE4A5, C_CCE4A5_CRY, C_CCE4A5_DOOM },  // Middle green-yellow
+    { 0xCCEA5F, C_CCEA5F_CRY, C_CCEA5F_DOOM },  // Bright green-yellow
+    { 0xB30202, C_B30202_CRY, C_B30202_DOOM },  // Middle red
+    { 0xB87A15, C_B87A15_CRY, C_B87A15_DOOM },  // Middle orange
+    { 0xFFD000, C_FFD000_CRY, C_FFD000_DOOM },  // Middle yellow
+    { 0xFFDE4C, C_FFDE4C_CRY, C_FFDE4C_DOOM },  // Middle-bright yellow
+    { 0xFFF588, C_FFF588_CRY, C_FFF588_DOOM },  // Bright yellow
+    { 0x3089FF, C_3089FF_CRY, C_3089FF_DOOM },  // Bright cyanic blue (also 043B84)
+    { 0xA88139, C_A88139_CRY, C_A88139_DOOM },  // Middle brown
+    { 0x7084C4, C_7084C4_CRY, C_7084C4_DOOM },  // Dark cyanic blue 2
+    { 0xD46D3D, C_D46D3D_CRY, C_D46D3D_DOOM },  // Middle orange 2
+    { 0x05A8A0, C_05A8A0_CRY, C_05A8A0_DOOM },  // Middle saturated cyan
+    { 0xFF3030, C_FF3030_CRY, C_FF3030_DOOM },  // Bright saturated red
+    { 0x6435B5, C_6435B5_CRY, C_6435B5_DOOM },  // Un-darked magenta
+    { 0xFFAFAF, C_FFAFAF_CRY, C_FFAFAF_DOOM },  // Brighter red (also FFCECE)
+    { 0xECB866, C_ECB866_CRY, C_ECB866_DOOM },  // Bright orange
+    { 0xC63F23, C_C63F23_CRY, C_C63F23_DOOM },  // Middle orange 3
+    { 0x9BC8CD, C_9BC8CD_CRY, C_9BC8CD_DOOM },  // Bright cyan (also 4F5D8B)
+    { 0x666666, C_666666_CRY, C_666666_DOOM },  // Special green (00FF00, overlay 33%)
+    { 0x777777, C_777777_CRY, C_777777_DOOM },  // Special red (FF0000, overlay 55%)
+};
 
-static inline void R_InitColoredColormap (const byte k, const float scale, const byte *lump_name, lighttable_t *colormap_name, const int j)
+// [JN] Colormaps and light tables of a color. They are only generated
+// when the color is drawn for the first time, and are freed again when
+// a level is loaded, or when the main tables they follow are changed.
+typedef struct
 {
-    const int r_clrmp_color = gammatable[vid_gamma][lump_name[3 * k + 0]] * (1. - scale) + gammatable[vid_gamma][0] * scale;
-    const int g_clrmp_color = gammatable[vid_gamma][lump_name[3 * k + 1]] * (1. - scale) + gammatable[vid_gamma][0] * scale;
-    const int b_clrmp_color = gammatable[vid_gamma][lump_name[3 * k + 2]] * (1. - scale) + gammatable[vid_gamma][0] * scale;
-    
-    colormap_name[j] = 0xff000000 | (r_clrmp_color << 16) | (g_clrmp_color << 8) | b_clrmp_color;
-}
+    lighttable_t  colormaps[(NUMCOLORMAPS + 1) * 256];
+    lighttable_t *scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
+    lighttable_t *zlight[LIGHTLEVELS][MAXLIGHTZ];
+} collittables_t;
 
-void R_GenerateColoredColormaps (const byte k, const float scale, const int j)
-{
-    const byte *C_EEC06B;
-    const byte *C_D97C45;
-    const byte *C_FF7F7F;
-    const byte *C_55B828;
-    const byte *C_BBE357;
-    const byte *C_949DB9;
-    const byte *C_2B3BFF;
-    const byte *C_50ADAC;
-    const byte *C_CCE4A5;
-    const byte *C_CCEA5F;
-    const byte *C_B30202;
-    const byte *C_B87A15;
-    const byte *C_FFD000;
-    const byte *C_FFDE4C;
-    const byte *C_FFF588;
-    const byte *C_3089FF;
-    const byte *C_A88139;
-    const byte *C_7084C4;
-    const byte *C_D46D3D;
-    const byte *C_05A8A0;
-    const byte *C_FF3030;
-    const byte *C_6435B5;
-    const byte *C_FFAFAF;
-    const byte *C_ECB866;
-    const byte *C_C63F23;
-    const byte *C_9BC8CD;
-    const byte *C_666666;
-    const byte *C_777777;
-
-    if (dp_cry_palette)
-    {
-        C_EEC06B = C_EEC06B_CRY;
-        C_D97C45 = C_D97C45_CRY;
-        C_FF7F7F = C_FF7F7F_CRY;
-        C_55B828 = C_55B828_CRY;
-        C_BBE357 = C_BBE357_CRY;
-        C_949DB9 = C_949DB9_CRY;
-        C_2B3BFF = C_2B3BFF_CRY;
-        C_50ADAC = C_50ADAC_CRY;
-        C_CCE4A5 = C_CCE4A5_CRY;
-        C_CCEA5F = C_CCEA5F_CRY;
-        C_B30202 = C_B30202_CRY;
-        C_B87A15 = C_B87A15_CRY;
-        C_FFD000 = C_FFD000_CRY;
-        C_FFDE4C = C_FFDE4C_CRY;
-        C_FFF588 = C_FFF588_CRY;
-        C_3089FF = C_3089FF_CRY;
-        C_A88139 = C_A88139_CRY;
-        C_7084C4 = C_7084C4_CRY;
-        C_D46D3D = C_D46D3D_CRY;
-        C_05A8A0 = C_05A8A0_CRY;
-        C_FF3030 = C_FF3030_CRY;
-        C_6435B5 = C_6435B5_CRY;
-        C_FFAFAF = C_FFAFAF_CRY;
-        C_ECB866 = C_ECB866_CRY;
-        C_C63F23 = C_C63F23_CRY;
-        C_9BC8CD = C_9BC8CD_CRY;
-        C_666666 = C_666666_CRY;
-        C_777777 = C_777777_CRY;
-    }
-    else
-    {
-        C_EEC06B = C_EEC06B_DOOM;
-        C_D97C45 = C_D97C45_DOOM;
-        C_FF7F7F = C_FF7F7F_DOOM;
-        C_55B828 = C_55B828_DOOM;
-        C_BBE357 = C_BBE357_DOOM;
-        C_949DB9 = C_949DB9_DOOM;
-        C_2B3BFF = C_2B3BFF_DOOM;
-        C_50ADAC = C_50ADAC_DOOM;
-        C_CCE4A5 = C_CCE4A5_DOOM;
-        C_CCEA5F = C_CCEA5F_DOOM;
-        C_B30202 = C_B30202_DOOM;
-        C_B87A15 = C_B87A15_DOOM;
-        C_FFD000 = C_FFD000_DOOM;
-        C_FFDE4C = C_FFDE4C_DOOM;
-        C_FFF588 = C_FFF588_DOOM;
-        C_3089FF = C_3089FF_DOOM;
-        C_A88139 = C_A88139_DOOM;
-        C_7084C4 = C_7084C4_DOOM;
-        C_D46D3D = C_D46D3D_DOOM;
-        C_05A8A0 = C_05A8A0_DOOM;
-        C_FF3030 = C_FF3030_DOOM;
-        C_6435B5 = C_6435B5_DOOM;
-        C_FFAFAF = C_FFAFAF_DOOM;
-        C_ECB866 = C_ECB866_DOOM;
-        C_C63F23 = C_C63F23_DOOM;
-        C_9BC8CD = C_9BC8CD_DOOM;
-        C_666666 = C_666666_DOOM;
-        C_777777 = C_777777_DOOM;
-    }
-    
-    R_InitColoredColormap(k, scale, C_EEC06B, colormaps_EEC06B, j);
-    R_InitColoredColormap(k, scale, C_D97C45, colormaps_D97C45, j);
-    R_InitColoredColormap(k, scale, C_FF7F7F, colormaps_FF7F7F, j);
-    R_InitColoredColormap(k, scale, C_55B828, colormaps_55B828, j);
-    R_InitColoredColormap(k, scale, C_BBE357, colormaps_BBE357, j);
-    R_InitColoredColormap(k, scale, C_949DB9, colormaps_949DB9, j);
-    R_InitColoredColormap(k, scale, C_2B3BFF, colormaps_2B3BFF, j);
-    R_InitColoredColormap(k, scale, C_50ADAC, colormaps_50ADAC, j);
-    R_InitColoredColormap(k, scale, C_CCE4A5, colormaps_CCE4A5, j);
-    R_InitColoredColormap(k, scale, C_CCEA5F, colormaps_CCEA5F, j);
-    R_InitColoredColormap(k, scale, C_B30202, colormaps_B30202, j);
-    R_InitColoredColormap(k, scale, C_B87A15, colormaps_B87A15, j);
-    R_InitColoredColormap(k, scale, C_FFD000, colormaps_FFD000, j);
-    R_InitColoredColormap(k, scale, C_FFDE4C, colormaps_FFDE4C, j);
-    R_InitColoredColormap(k, scale, C_FFF588, colormaps_FFF588, j);
-    R_InitColoredColormap(k, scale, C_3089FF, colormaps_3089FF, j);
-    R_InitColoredColormap(k, scale, C_A88139, colormaps_A88139, j);
-    R_InitColoredColormap(k, scale, C_7084C4, colormaps_7084C4, j);
-    R_InitColoredColormap(k, scale, C_D46D3D, colormaps_D46D3D, j);
-    R_InitColoredColormap(k, scale, C_05A8A0, colormaps_05A8A0, j);
-    R_InitColoredColormap(k, scale, C_FF3030, colormaps_FF3030, j);
-    R_InitColoredColormap(k, scale, C_6435B5, colormaps_6435B5, j);
-    R_InitColoredColormap(k, scale, C_FFAFAF, colormaps_FFAFAF, j);
-    R_InitColoredColormap(k, scale, C_ECB866, colormaps_C63F23, j);
-    R_InitColoredColormap(k, scale, C_C63F23, colormaps_ECB866, j);
-    R_InitColoredColormap(k, scale, C_9BC8CD, colormaps_9BC8CD, j);
-    R_InitColoredColormap(k, scale, C_666666, colormaps_666666, j);
-    R_InitColoredColormap(k, scale, C_777777, colormaps_777777, j);
-}
+static collittables_t *collit_tables[NUMCOLLIT];
 
 // =============================================================================
 //
-//                          INITIALIZATION FUNCTIONS
+//                             COMPOSING FUNCTIONS
 //
 // =============================================================================
 
-void R_InitColoredLightTables (void)
+int R_ColoredLightIndex (const int rgb)
 {
-    int i, j;
-    int level, scale, startmap;
-    const size_t sclight_size     = LIGHTLEVELS * sizeof(*scalelight);
-    const size_t sclight_size_max = MAXLIGHTSCALE * sizeof(**scalelight);
-    const size_t zlight_size      = LIGHTLEVELS * sizeof(*zlight);
-    const size_t zlight_size_max  = MAXLIGHTZ * sizeof(**zlight);
-
-    // [JN] Don't allocate/calculate anything if colored lighting is disabled.
-    if (!vis_colored_lighting)
+    for (int i = 1 ; i < NUMCOLLIT ; i++)
     {
-        return;
-    }
-  
-    scalelight_EEC06B = malloc(sclight_size);
-    scalelight_D97C45 = malloc(sclight_size);
-    scalelight_FF7F7F = malloc(sclight_size);
-    scalelight_55B828 = malloc(sclight_size);
-    scalelight_BBE357 = malloc(sclight_size);
-    scalelight_949DB9 = malloc(sclight_size);
-    scalelight_2B3BFF = malloc(sclight_size);
-    scalelight_50ADAC = malloc(sclight_size);
-    scalelight_CCE4A5 = malloc(sclight_size);
-    scalelight_CCEA5F = malloc(sclight_size);
-    scalelight_B30202 = malloc(sclight_size);
-    scalelight_B87A15 = malloc(sclight_size);
-    scalelight_FFD000 = malloc(sclight_size);
-    scalelight_FFDE4C = malloc(sclight_size);
-    scalelight_FFF588 = malloc(sclight_size);
-    scalelight_3089FF = malloc(sclight_size);
-    scalelight_A88139 = malloc(sclight_size);
-    scalelight_7084C4 = malloc(sclight_size);
-    scalelight_D46D3D = malloc(sclight_size);
-    scalelight_05A8A0 = malloc(sclight_size);
-    scalelight_FF3030 = malloc(sclight_size);
-    scalelight_6435B5 = malloc(sclight_size);
-    scalelight_FFAFAF = malloc(sclight_size);
-    scalelight_ECB866 = malloc(sclight_size);
-    scalelight_C63F23 = malloc(sclight_size);
-    scalelight_9BC8CD = malloc(sclight_size);
-    scalelight_666666 = malloc(sclight_size);
-    scalelight_777777 = malloc(sclight_size);
-
-    zlight_EEC06B = malloc(zlight_size);
-    zlight_D97C45 = malloc(zlight_size);
-    zlight_FF7F7F = malloc(zlight_size);
-    zlight_55B828 = malloc(zlight_size);
-    zlight_BBE357 = malloc(zlight_size);
-    zlight_949DB9 = malloc(zlight_size);
-    zlight_2B3BFF = malloc(zlight_size);
-    zlight_50ADAC = malloc(zlight_size);
-    zlight_CCE4A5 = malloc(zlight_size);
-    zlight_CCEA5F = malloc(zlight_size);
-    zlight_B30202 = malloc(zlight_size);
-    zlight_B87A15 = malloc(zlight_size);
-    zlight_FFD000 = malloc(zlight_size);
-    zlight_FFDE4C = malloc(zlight_size);
-    zlight_FFF588 = malloc(zlight_size);
-    zlight_3089FF = malloc(zlight_size);
-    zlight_A88139 = malloc(zlight_size);
-    zlight_7084C4 = malloc(zlight_size);
-    zlight_D46D3D = malloc(zlight_size);
-    zlight_05A8A0 = malloc(zlight_size);
-    zlight_FF3030 = malloc(zlight_size);
-    zlight_6435B5 = malloc(zlight_size);
-    zlight_FFAFAF = malloc(zlight_size);
-    zlight_ECB866 = malloc(zlight_size);
-    zlight_C63F23 = malloc(zlight_size);
-    zlight_9BC8CD = malloc(zlight_size);
-    zlight_666666 = malloc(zlight_size);
-    zlight_777777 = malloc(zlight_size);
-
-    // Calculate the light levels to use for each level / distance combination.
-    for (i = 0 ; i < LIGHTLEVELS ; i++)
-    {
-        scalelight_EEC06B[i] = malloc(sclight_size_max);
-        scalelight_D97C45[i] = malloc(sclight_size_max);
-        scalelight_FF7F7F[i] = malloc(sclight_size_max);
-        scalelight_55B828[i] = malloc(sclight_size_max);
-        scalelight_BBE357[i] = malloc(sclight_size_max);
-        scalelight_949DB9[i] = malloc(sclight_size_max);
-        scalelight_2B3BFF[i] = malloc(sclight_size_max);
-        scalelight_50ADAC[i] = malloc(sclight_size_max);
-        scalelight_CCE4A5[i] = malloc(sclight_size_max);
-        scalelight_CCEA5F[i] = malloc(sclight_size_max);
-        scalelight_B30202[i] = malloc(sclight_size_max);
-        scalelight_B87A15[i] = malloc(sclight_size_max);
-        scalelight_FFD000[i] = malloc(sclight_size_max);
-        scalelight_FFDE4C[i] = malloc(sclight_size_max);
-        scalelight_FFF588[i] = malloc(sclight_size_max);
-        scalelight_3089FF[i] = malloc(sclight_size_max);
-        scalelight_A88139[i] = malloc(sclight_size_max);
-        scalelight_7084C4[i] = malloc(sclight_size_max);
-        scalelight_D46D3D[i] = malloc(sclight_size_max);
-        scalelight_05A8A0[i] = malloc(sclight_size_max);
-        scalelight_FF3030[i] = malloc(sclight_size_max);
-        scalelight_6435B5[i] = malloc(sclight_size_max);
-        scalelight_FFAFAF[i] = malloc(sclight_size_max);
-        scalelight_ECB866[i] = malloc(sclight_size_max);
-        scalelight_C63F23[i] = malloc(sclight_size_max);
-        scalelight_9BC8CD[i] = malloc(sclight_size_max);
-        scalelight_666666[i] = malloc(sclight_size_max);
-        scalelight_777777[i] = malloc(sclight_size_max);
-
-        zlight_EEC06B[i] = malloc(zlight_size_max);
-        zlight_D97C45[i] = malloc(zlight_size_max);
-        zlight_FF7F7F[i] = malloc(zlight_size_max);
-        zlight_55B828[i] = malloc(zlight_size_max);
-        zlight_BBE357[i] = malloc(zlight_size_max);
-        zlight_949DB9[i] = malloc(zlight_size_max);
-        zlight_2B3BFF[i] = malloc(zlight_size_max);
-        zlight_50ADAC[i] = malloc(zlight_size_max);
-        zlight_CCE4A5[i] = malloc(zlight_size_max);
-        zlight_CCEA5F[i] = malloc(zlight_size_max);
-        zlight_B30202[i] = malloc(zlight_size_max);
-        zlight_B87A15[i] = malloc(zlight_size_max);
-        zlight_FFD000[i] = malloc(zlight_size_max);
-        zlight_FFDE4C[i] = malloc(zlight_size_max);
-        zlight_FFF588[i] = malloc(zlight_size_max);
-        zlight_3089FF[i] = malloc(zlight_size_max);
-        zlight_A88139[i] = malloc(zlight_size_max);
-        zlight_7084C4[i] = malloc(zlight_size_max);
-        zlight_D46D3D[i] = malloc(zlight_size_max);
-        zlight_05A8A0[i] = malloc(zlight_size_max);
-        zlight_FF3030[i] = malloc(zlight_size_max);
-        zlight_6435B5[i] = malloc(zlight_size_max);
-        zlight_FFAFAF[i] = malloc(zlight_size_max);
-        zlight_ECB866[i] = malloc(zlight_size_max);
-        zlight_C63F23[i] = malloc(zlight_size_max);
-        zlight_9BC8CD[i] = malloc(zlight_size_max);
-        zlight_666666[i] = malloc(zlight_size_max);
-        zlight_777777[i] = malloc(zlight_size_max);
-        
-        startmap = ((LIGHTLEVELS - LIGHTBRIGHT - i) * 2) * NUMCOLORMAPS / LIGHTLEVELS;
-
-        for (j = 0 ; j < MAXLIGHTZ ; j++)
+        if (collit_colors[i].rgb == rgb)
         {
-            scale = (FixedDiv ((ORIGWIDTH / 2 * FRACUNIT), (j + 1) << LIGHTZSHIFT)) >> LIGHTSCALESHIFT;
-            level = BETWEEN(0, NUMCOLORMAPS - 1, startmap - (scale >> 1)) * 256;
-
-            zlight_EEC06B[i][j] = colormaps_EEC06B + level;
-            zlight_D97C45[i][j] = colormaps_D97C45 + level;
-            zlight_FF7F7F[i][j] = colormaps_FF7F7F + level;
-            zlight_55B828[i][j] = colormaps_55B828 + level;
-            zlight_BBE357[i][j] = colormaps_BBE357 + level;
-            zlight_949DB9[i][j] = colormaps_949DB9 + level;
-            zlight_2B3BFF[i][j] = colormaps_2B3BFF + level;
-            zlight_50ADAC[i][j] = colormaps_50ADAC + level;
-            zlight_CCE4A5[i][j] = colormaps_CCE4A5 + level;
-            zlight_CCEA5F[i][j] = colormaps_CCEA5F + level;
-            zlight_B30202[i][j] = colormaps_B30202 + level;
-            zlight_B87A15[i][j] = colormaps_B87A15 + level;
-            zlight_FFD000[i][j] = colormaps_FFD000 + level;
-            zlight_FFDE4C[i][j] = colormaps_FFDE4C + level;
-            zlight_FFF588[i][j] = colormaps_FFF588 + level;
-            zlight_3089FF[i][j] = colormaps_3089FF + level;
-            zlight_A88139[i][j] = colormaps_A88139 + level;
-            zlight_7084C4[i][j] = colormaps_7084C4 + level;
-            zlight_D46D3D[i][j] = colormaps_D46D3D + level;
-            zlight_05A8A0[i][j] = colormaps_05A8A0 + level;
-            zlight_FF3030[i][j] = colormaps_FF3030 + level;
-            zlight_6435B5[i][j] = colormaps_6435B5 + level;
-            zlight_FFAFAF[i][j] = colormaps_FFAFAF + level;
-            zlight_ECB866[i][j] = colormaps_ECB866 + level;
-            zlight_C63F23[i][j] = colormaps_C63F23 + level;
-            zlight_9BC8CD[i][j] = colormaps_9BC8CD + level;
-            zlight_666666[i][j] = colormaps_666666 + level;
-            zlight_777777[i][j] = colormaps_777777 + level;
+            return i;
         }
     }
+
+    return 0;
 }
 
-void R_GenerateColoredSClights (const int width)
+// [JN] Colormaps fade the colored palette to black just like the main
+// ones do, see R_InitColormaps. Gamma correction is left to the video
+// output. The light tables pick the same levels as the main
+// scalelight[][] and zlight[][] do.
+
+static collittables_t *R_GenerateColoredTables (const int color)
 {
-    int i, j;
-    int level, startmap;
+    collittables_t *const tables = malloc(sizeof(*tables));
+    const byte *const lump = dp_cry_palette ? collit_colors[color].lump_cry :
+                                              collit_colors[color].lump_doom;
 
-    // [JN] Don't calculate anything if colored lighting is disabled.
-    if (!vis_colored_lighting)
+    if (tables == NULL)
     {
-        return;
+        I_Error("R_GenerateColoredTables: failed to allocate %d bytes",
+                (int) sizeof(*tables));
     }
 
-    // Calculate the light levels to use for each level / scale combination.
-    for (i = 0 ; i < LIGHTLEVELS ; i++)
+    for (int c = 0 ; c < NUMCOLORMAPS ; c++)
     {
-        startmap = ((LIGHTLEVELS - LIGHTBRIGHT - i) * 2) * NUMCOLORMAPS / LIGHTLEVELS;
+        const float scale = (float) c / NUMCOLORMAPS;
+        lighttable_t *const row = &tables->colormaps[c * 256];
 
-        for (j = 0 ; j < MAXLIGHTSCALE ; j++)
+        for (int k = 0 ; k < 256 ; k++)
         {
-            level = BETWEEN(0, NUMCOLORMAPS - 1, startmap - ((j * NONWIDEWIDTH / (width << detailshift)) >> 1)) * 256;
-
-            scalelight_EEC06B[i][j] = colormaps_EEC06B + level;
-            scalelight_D97C45[i][j] = colormaps_D97C45 + level;
-            scalelight_FF7F7F[i][j] = colormaps_FF7F7F + level;
-            scalelight_55B828[i][j] = colormaps_55B828 + level;
-            scalelight_BBE357[i][j] = colormaps_BBE357 + level;
-            scalelight_949DB9[i][j] = colormaps_949DB9 + level;
-            scalelight_2B3BFF[i][j] = colormaps_2B3BFF + level;
-            scalelight_50ADAC[i][j] = colormaps_50ADAC + level;
-            scalelight_CCE4A5[i][j] = colormaps_CCE4A5 + level;
-            scalelight_CCEA5F[i][j] = colormaps_CCEA5F + level;
-            scalelight_B30202[i][j] = colormaps_B30202 + level;
-            scalelight_B87A15[i][j] = colormaps_B87A15 + level;
-            scalelight_FFD000[i][j] = colormaps_FFD000 + level;
-            scalelight_FFDE4C[i][j] = colormaps_FFDE4C + level;
-            scalelight_FFF588[i][j] = colormaps_FFF588 + level;
-            scalelight_3089FF[i][j] = colormaps_3089FF + level;
-            scalelight_A88139[i][j] = colormaps_A88139 + level;
-            scalelight_7084C4[i][j] = colormaps_7084C4 + level;
-            scalelight_D46D3D[i][j] = colormaps_D46D3D + level;
-            scalelight_05A8A0[i][j] = colormaps_05A8A0 + level;
-            scalelight_FF3030[i][j] = colormaps_FF3030 + level;
-            scalelight_6435B5[i][j] = colormaps_6435B5 + level;
-            scalelight_FFAFAF[i][j] = colormaps_FFAFAF + level;
-            scalelight_ECB866[i][j] = colormaps_ECB866 + level;
-            scalelight_C63F23[i][j] = colormaps_C63F23 + level;
-            scalelight_9BC8CD[i][j] = colormaps_9BC8CD + level;
-            scalelight_666666[i][j] = colormaps_666666 + level;
-            scalelight_777777[i][j] = colormaps_777777 + level;
+            const int r = lump[3 * k + 0] * (1. - scale);
+            const int g = lump[3 * k + 1] * (1. - scale);
+            const int b = lump[3 * k + 2] * (1. - scale);
+
+            row[k] = 0xff000000 | (r << 16) | (g << 8) | b;
         }
     }
-}
-
-void R_FreeColoredLights (void)
-{
-    int i;
 
-    // [JN] Fail-safe: do not try to free lighttables
-    // if at least the first one was not allocated.
-    if (scalelight_EEC06B)
+    for (int i = 0 ; i < LIGHTLEVELS ; i++)
     {
-        for (i = 0 ; i < LIGHTLEVELS ; i++)
+        for (int j = 0 ; j < MAXLIGHTSCALE ; j++)
         {
-            free(scalelight_EEC06B[i]);
-            free(scalelight_D97C45[i]);
-            free(scalelight_FF7F7F[i]);
-            free(scalelight_55B828[i]);
-            free(scalelight_BBE357[i]);
-            free(scalelight_949DB9[i]);
-            free(scalelight_2B3BFF[i]);
-            free(scalelight_50ADAC[i]);
-            free(scalelight_CCE4A5[i]);
-            free(scalelight_CCEA5F[i]);
-            free(scalelight_B30202[i]);
-            free(scalelight_B87A15[i]);
-            free(scalelight_FFD000[i]);
-            free(scalelight_FFDE4C[i]);
-            free(scalelight_FFF588[i]);
-            free(scalelight_3089FF[i]);
-            free(scalelight_A88139[i]);
-            free(scalelight_7084C4[i]);
-            free(scalelight_D46D3D[i]);
-            free(scalelight_05A8A0[i]);
-            free(scalelight_FF3030[i]);
-            free(scalelight_6435B5[i]);
-            free(scalelight_FFAFAF[i]);
-            free(scalelight_ECB866[i]);
-            free(scalelight_C63F23[i]);
-            free(scalelight_9BC8CD[i]);
-            free(scalelight_666666[i]);
-            free(scalelight_777777[i]);
+            tables->scalelight[i][j] = tables->colormaps
+                                     + (scalelight[i][j] - colormaps);
         }
 
-        free(scalelight_EEC06B);
-        free(scalelight_D97C45);
-        free(scalelight_FF7F7F);
-        free(scalelight_55B828);
-        free(scalelight_BBE357);
-        free(scalelight_949DB9);
-        free(scalelight_2B3BFF);
-        free(scalelight_50ADAC);
-        free(scalelight_CCE4A5);
-        free(scalelight_CCEA5F);
-        free(scalelight_B30202);
-        free(scalelight_B87A15);
-        free(scalelight_FFD000);
-        free(scalelight_FFDE4C);
-        free(scalelight_FFF588);
-        free(scalelight_3089FF);
-        free(scalelight_A88139);
-        free(scalelight_7084C4);
-        free(scalelight_D46D3D);
-        free(scalelight_05A8A0);
-        free(scalelight_FF3030);
-        free(scalelight_6435B5);
-        free(scalelight_FFAFAF);
-        free(scalelight_ECB866);
-        free(scalelight_C63F23);
-        free(scalelight_9BC8CD);
-        free(scalelight_666666);
-        free(scalelight_777777);
-
-        for (i = 0; i < LIGHTLEVELS; i++)
+        for (int j = 0 ; j < MAXLIGHTZ ; j++)
         {
-            free(zlight_EEC06B[i]);
-            free(zlight_D97C45[i]);
-            free(zlight_FF7F7F[i]);
-            free(zlight_55B828[i]);
-            free(zlight_BBE357[i]);
-            free(zlight_949DB9[i]);
-            free(zlight_2B3BFF[i]);
-            free(zlight_50ADAC[i]);
-            free(zlight_CCE4A5[i]);
-            free(zlight_CCEA5F[i]);
-            free(zlight_B30202[i]);
-            free(zlight_B87A15[i]);
-            free(zlight_FFD000[i]);
-            free(zlight_FFDE4C[i]);
-            free(zlight_FFF588[i]);
-            free(zlight_3089FF[i]);
-            free(zlight_A88139[i]);
-            free(zlight_7084C4[i]);
-            free(zlight_D46D3D[i]);
-            free(zlight_05A8A0[i]);
-            free(zlight_FF3030[i]);
-            free(zlight_6435B5[i]);
-            free(zlight_FFAFAF[i]);
-            free(zlight_ECB866[i]);
-            free(zlight_C63F23[i]);
-            free(zlight_9BC8CD[i]);
-            free(zlight_666666[i]);
-            free(zlight_777777[i]);
+            tables->zlight[i][j] = tables->colormaps + (zlight[i][j] - colormaps);
         }
+    }
+
+    collit_tables[color] = tables;
+
+    return tables;
+}
+
+static inline collittables_t *R_ColoredTables (const int color)
+{
+    collittables_t *const tables = collit_tables[color];
 
-        free(zlight_EEC06B);
-        free(zlight_D97C45);
-        free(zlight_FF7F7F);
-        free(zlight_55B828);
-        free(zlight_BBE357);
-        free(zlight_949DB9);
-        free(zlight_2B3BFF);
-        free(zlight_50ADAC);
-        free(zlight_CCE4A5);
-        free(zlight_CCEA5F);
-        free(zlight_B30202);
-        free(zlight_B87A15);
-        free(zlight_FFD000);
-        free(zlight_FFDE4C);
-        free(zlight_FFF588);
-        free(zlight_3089FF);
-        free(zlight_A88139);
-        free(zlight_7084C4);
-        free(zlight_D46D3D);
-        free(zlight_05A8A0);
-        free(zlight_FF3030);
-        free(zlight_6435B5);
-        free(zlight_FFAFAF);
-        free(zlight_ECB866);
-        free(zlight_C63F23);
-        free(zlight_9BC8CD);
-        free(zlight_666666);
-        free(zlight_777777);
-
-        // [JN] Indicate that freed light tables
-        // can't be freed again until future reallocation.
-        scalelight_EEC06B = NULL;
-    }    
+    return tables != NULL ? tables : R_GenerateColoredTables(color);
+}
+
+// =============================================================================
+//
+//                          INITIALIZATION FUNCTIONS
+//
+// =============================================================================
+
+void R_FreeColoredLights (void)
+{
+    for (int i = 0 ; i < NUMCOLLIT ; i++)
+    {
+        free(collit_tables[i]);
+        collit_tables[i] = NULL;
+    }
 }
 
 // =============================================================================
@@ -673,40 +191,10 @@ lighttable_t **R_ColoredVisplanesColorize (const int light, const int color)
     {
         return zlight_INVULN[light];
     }
-    
-    if (vis_colored_lighting)
+
+    if (vis_colored_lighting && color)
     {
-        switch (color)
-        {
-            case 0xEEC06B:  return zlight_EEC06B[light]; break;
-            case 0xD97C45:  return zlight_D97C45[light]; break;
-            case 0xFF7F7F:  return zlight_FF7F7F[light]; break;
-            case 0x55B828:  return zlight_55B828[light]; break;
-            case 0xBBE357:  return zlight_BBE357[light]; break;
-            case 0x949DB9:  return zlight_949DB9[light]; break;
-            case 0x2B3BFF:  return zlight_2B3BFF[light]; break;
-            case 0x50ADAC:  return zlight_50ADAC[light]; break;
-            case 0xCCE4A5:  return zlight_CCE4A5[light]; break;
-            case 0xCCEA5F:  return zlight_CCEA5F[light]; break;
-            case 0xB30202:  return zlight_B30202[light]; break;
-            case 0xB87A15:  return zlight_B87A15[light]; break;
-            case 0xFFD000:  return zlight_FFD000[light]; break;
-            case 0xFFDE4C:  return zlight_FFDE4C[light]; break;
-            case 0xFFF588:  return zlight_FFF588[light]; break;
-            case 0x3089FF:  return zlight_3089FF[light]; break;
-            case 0xA88139:  return zlight_A88139[light]; break;
-            case 0x7084C4:  return zlight_7084C4[light]; break;
-            case 0xD46D3D:  return zlight_D46D3D[light]; break;
-            case 0x05A8A0:  return zlight_05A8A0[light]; break;
-            case 0xFF3030:  return zlight_FF3030[light]; break;
-            case 0x6435B5:  return zlight_6435B5[light]; break;
-            case 0xFFAFAF:  return zlight_FFAFAF[light]; break;
-            case 0xECB866:  return zlight_C63F23[light]; break;
-            case 0xC63F23:  return zlight_ECB866[light]; break;
-            case 0x9BC8CD:  return zlight_9BC8CD[light]; break;
-            case 0x666666:  return zlight_666666[light]; break;
-            case 0x777777:  return zlight_777777[light]; break;
-        }
+        return R_ColoredTables(color)->zlight[light];
     }
 
     return zlight[light];
@@ -721,39 +209,9 @@ lighttable_t **R_ColoredSegsColorize (const int lightnum, const int color)
         return scalelight_INVULN[BETWEEN(0, l, lightnum)];
     }
 
-    if (vis_colored_lighting)
+    if (vis_colored_lighting && color)
     {
-        switch (color)
-        {
-            case 0xEEC06B:  return scalelight_EEC06B[BETWEEN(0, l, lightnum)];  break;
-            case 0xD97C45:  return scalelight_D97C45[BETWEEN(0, l, lightnum)];  break;
-            case 0xFF7F7F:  return scalelight_FF7F7F[BETWEEN(0, l, lightnum)];  break;
-            case 0x55B828:  return scalelight_55B828[BETWEEN(0, l, lightnum)];  break;
-            case 0xBBE357:  return scalelight_BBE357[BETWEEN(0, l, lightnum)];  break;
-            case 0x949DB9:  return scalelight_949DB9[BETWEEN(0, l, lightnum)];  break;
-            case 0x2B3BFF:  return scalelight_2B3BFF[BETWEEN(0, l, lightnum)];  break;
-            case 0x50ADAC:  return scalelight_50ADAC[BETWEEN(0, l, lightnum)];  break;
-            case 0xCCE4A5:  return scalelight_CCE4A5[BETWEEN(0, l, lightnum)];  break;
-            case 0xCCEA5F:  return scalelight_CCEA5F[BETWEEN(0, l, lightnum)];  break;
-            case 0xB30202:  return scalelight_B30202[BETWEEN(0, l, lightnum)];  break;
-            case 0xB87A15:  return scalelight_B87A15[BETWEEN(0, l, lightnum)];  break;
-            case 0xFFD000:  return scalelight_FFD000[BETWEEN(0, l, lightnum)];  break;
-            case 0xFFDE4C:  return scalelight_FFDE4C[BETWEEN(0, l, lightnum)];  break;
-            case 0xFFF588:  return scalelight_FFF588[BETWEEN(0, l, lightnum)];  break;
-            case 0x3089FF:  return scalelight_3089FF[BETWEEN(0, l, lightnum)];  break;
-            case 0xA88139:  return scalelight_A88139[BETWEEN(0, l, lightnum)];  break;
-            case 0x7084C4:  return scalelight_7084C4[BETWEEN(0, l, lightnum)];  break;
-            case 0xD46D3D:  return scalelight_D46D3D[BETWEEN(0, l, lightnum)];  break;
-            case 0x05A8A0:  return scalelight_05A8A0[BETWEEN(0, l, lightnum)];  break;
-            case 0xFF3030:  return scalelight_FF3030[BETWEEN(0, l, lightnum)];  break;
-            case 0x6435B5:  return scalelight_6435B5[BETWEEN(0, l, lightnum)];  break;
-            case 0xFFAFAF:  return scalelight_FFAFAF[BETWEEN(0, l, lightnum)];  break;
-            case 0xECB866:  return scalelight_C63F23[BETWEEN(0, l, lightnum)];  break;
-            case 0xC63F23:  return scalelight_ECB866[BETWEEN(0, l, lightnum)];  break;
-            case 0x9BC8CD:  return scalelight_9BC8CD[BETWEEN(0, l, lightnum)];  break;
-            case 0x666666:  return scalelight_666666[BETWEEN(0, l, lightnum)];  break;
-            case 0x777777:  return scalelight_777777[BETWEEN(0, l, lightnum)];  break;
-        }
+        return R_ColoredTables(color)->scalelight[BETWEEN(0, l, lightnum)];
     }
 
     return scalelight[BETWEEN(0, l, lightnum)]; 
@@ -765,40 +223,10 @@ lighttable_t *R_ColoredSprColorize (const int color)
     {
         return invulmaps;
     }
-        
-    if (vis_colored_lighting)
+
+    if (vis_colored_lighting && color)
     {
-        switch (color)
-        {
-            case 0xEEC06B:  return colormaps_EEC06B;  break;
-            case 0xD97C45:  return colormaps_D97C45;  break;
-            case 0xFF7F7F:  return colormaps_FF7F7F;  break;
-            case 0x55B828:  return colormaps_55B828;  break;
-            case 0xBBE357:  return colormaps_BBE357;  break;
-            case 0x949DB9:  return colormaps_949DB9;  break;
-            case 0x2B3BFF:  return colormaps_2B3BFF;  break;
-            case 0x50ADAC:  return colormaps_50ADAC;  break;
-            case 0xCCE4A5:  return colormaps_CCE4A5;  break;
-            case 0xCCEA5F:  return colormaps_CCEA5F;  break;
-            case 0xB30202:  return colormaps_B30202;  break;
-            case 0xB87A15:  return colormaps_B87A15;  break;
-            case 0xFFD000:  return colormaps_FFD000;  break;
-            case 0xFFDE4C:  return colormaps_FFDE4C;  break;
-            case 0xFFF588:  return colormaps_FFF588;  break;
-            case 0x3089FF:  return colormaps_3089FF;  break;
-            case 0xA88139:  return colormaps_A88139;  break;
-            case 0x7084C4:  return colormaps_7084C4;  break;
-            case 0xD46D3D:  return colormaps_D46D3D;  break;
-            case 0x05A8A0:  return colormaps_05A8A0;  break;
-            case 0xFF3030:  return colormaps_FF3030;  break;
-            case 0x6435B5:  return colormaps_6435B5;  break;
-            case 0xFFAFAF:  return colormaps_FFAFAF;  break;
-            case 0xECB866:  return colormaps_C63F23;  break;
-            case 0xC63F23:  return colormaps_ECB866;  break;
-            case 0x9BC8CD:  return colormaps_9BC8CD;  break;
-            case 0x666666:  return colormaps_666666;  break;
-            case 0x777777:  return colormaps_777777;  break;
-        }
+        return R_ColoredTables(color)->colormaps;
     }
 
     return colormaps;
@@ -2899,7 +2327,7 @@ void P_ReloadSectorColorTable (int area)
                 {
                     if (sectorcolor[j].color)
                     {
-                        ss->color = sectorcolor[j].color;
+                        ss->color = R_ColoredLightIndex(sectorcolor[j].color);
                     }
                     break;
                 }
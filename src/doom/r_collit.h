@@ -51,12 +51,9 @@ extern const byte C_666666_CRY[], C_666666_DOOM[];
 extern const byte C_777777_CRY[], C_777777_DOOM[];
 
 // Composing functions
-extern void R_AllocateColoredColormaps (void);
-extern void R_GenerateColoredColormaps (const byte k, const float scale, const int j);
+extern int  R_ColoredLightIndex (const int rgb);
 
 // Initialization functions
-extern void R_InitColoredLightTables (void);
-extern void R_GenerateColoredSClights (const int width);
 extern void R_FreeColoredLights (void);
 
 // Coloring lookup tables
@@ -19,6 +19,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "z_zone.h"
 #include "w_wad.h"
 #include "m_misc.h"
@@ -126,7 +127,6 @@ texture_t **textures;
 texture_t **textures_hashtable;
 
 
-int *texturewidthmask;
 int *texturewidth;             // [crispy] texture width for wrapping column getter function
 fixed_t *textureheight;        // [crispy] texture height for Tutti-Frutti fix
 int *texturecompositesize;
@@ -137,6 +137,23 @@ byte **texturecomposite;       // [crispy] composited translucent mid-textures o
 byte **texturecomposite2;      // [crispy] composited opaque textures
 const byte **texturebrightmap; // [crispy] brightmaps
 
+// [JN] Both composite blocks start with a table of pointers to their
+// columns, followed by the columns themselves.
+#define COMPOSITE_COLUMNS(block) ((byte **) (block))
+
+// [JN] Wrapping of column numbers by texture width, using a multiplication
+// instead of a division. With shift = 32 + ceil(log2(width)) and magic =
+// ceil(2^shift / width), n * magic >> shift == n / width for any n below
+// 2^31. The bias is a multiple of the width that makes n positive.
+typedef struct
+{
+    uint64_t magic;
+    unsigned bias;
+    int      shift;
+} texturewrap_t;
+
+static texturewrap_t *texturewrap;
+
 // for global animation
 int *flattranslation;
 int *texturetranslation;
@@ -229,20 +246,70 @@ static void R_DrawColumnInCache
 }
 
 // -----------------------------------------------------------------------------
-// R_GenerateComposite
+// R_AllocComposite
+//  [JN] Allocate the composite blocks of a texture and lock its patches,
+//  which are returned for R_BuildComposite. Both stay PU_STATIC until
+//  R_FinishComposite.
+// -----------------------------------------------------------------------------
+
+static const patch_t **R_AllocComposite (int texnum)
+{
+    texture_t *const texture = textures[texnum];
+    const patch_t **const patches = malloc(texture->patchcount * sizeof(*patches));
+
+    if (patches == NULL)
+    {
+        I_Error("R_AllocComposite: out of memory (%.8s)", texture->name);
+    }
+
+    const size_t columns = (size_t)texture->width * sizeof(byte *);
+
+    Z_Malloc(columns + texturecompositesize[texnum], PU_STATIC, &texturecomposite[texnum]);
+    Z_Malloc(columns + (size_t)texture->width * (size_t)texture->height, PU_STATIC, &texturecomposite2[texnum]);
+
+    for (int i = 0; i < texture->patchcount; ++i)
+    {
+        patches[i] = W_CacheLumpNum(texture->patches[i].patch, PU_STATIC);
+    }
+
+    return patches;
+}
+
+static void R_FinishComposite (int texnum, const patch_t **patches)
+{
+    const texture_t *const texture = textures[texnum];
+
+    for (int i = 0; i < texture->patchcount; ++i)
+    {
+        W_ReleaseLumpNum(texture->patches[i].patch);
+    }
+
+    free(patches);
+
+    // Purgable from zone memory now that caches are built
+    Z_ChangeTag(texturecomposite[texnum],  PU_CACHE);
+    Z_ChangeTag(texturecomposite2[texnum], PU_CACHE);
+}
+
+// -----------------------------------------------------------------------------
+// R_BuildComposite
 //  [PN] Builds composite columns for a texture and reconstructs true posts from
 //  transparency marks with fewer branches and restrict-qualified pointers.
 //  Based on Killough’s rewrite that fixed the Medusa bug.
+//  [JN] Doesn't touch the zone memory or the WAD cache, so that textures
+//  can be composited on the worker threads, see R_PrecacheLevel.
 // -----------------------------------------------------------------------------
 
-static void R_GenerateComposite (int texnum)
+static void R_BuildComposite (int texnum, const patch_t *const *patches)
 {
     texture_t *const texture = textures[texnum];
     const int width  = texture->width;
     const int height = texture->height;
 
-    byte *const block = Z_Malloc(texturecompositesize[texnum], PU_STATIC, &texturecomposite[texnum]);
-    byte *const block2 = Z_Malloc((size_t)width * (size_t)height, PU_STATIC, &texturecomposite2[texnum]);
+    byte **const columns = COMPOSITE_COLUMNS(texturecomposite[texnum]);
+    byte **const columns2 = COMPOSITE_COLUMNS(texturecomposite2[texnum]);
+    byte *const block = (byte *) (columns + width);
+    byte *const block2 = (byte *) (columns2 + width);
 
     short    *restrict collump = texturecolumnlump[texnum];
     unsigned *restrict colofs  = texturecolumnofs [texnum];
@@ -258,7 +325,7 @@ static void R_GenerateComposite (int texnum)
     for (int i = 0; i < texture->patchcount; ++i)
     {
         const texpatch_t *const patch = &texture->patches[i];
-        const patch_t *const realpatch = W_CacheLumpNum(patch->patch, PU_CACHE);
+        const patch_t *const realpatch = patches[i];
 
         int x1 = patch->originx;
         int x2 = x1 + SHORT(realpatch->width);
@@ -292,6 +359,12 @@ static void R_GenerateComposite (int texnum)
     //    copy an opaque linear copy into block2 for fast sampling.
     byte *const source = (byte *)I_Realloc(NULL, (size_t)height); // temporary column
 
+    for (int i = 0; i < width; ++i)
+    {
+        columns[i] = block + colofs[i];
+        columns2[i] = block2 + colofs2[i];
+    }
+
     for (int i = 0; i < width; ++i)
     {
         column_t *col = (column_t *)(block + colofs[i] - 3); // cached column header
@@ -353,10 +426,14 @@ static void R_GenerateComposite (int texnum)
 
     free(source);
     free(marks);
+}
 
-    // Purgable from zone memory now that caches are built
-    Z_ChangeTag(block,  PU_CACHE);
-    Z_ChangeTag(block2, PU_CACHE);
+static void R_GenerateComposite (int texnum)
+{
+    const patch_t **const patches = R_AllocComposite(texnum);
+
+    R_BuildComposite(texnum, patches);
+    R_FinishComposite(texnum, patches);
 }
 
 // -----------------------------------------------------------------------------
@@ -484,6 +561,21 @@ static void R_GenerateLookup (int texnum)
     Z_Free(postcount);
 }
 
+// -----------------------------------------------------------------------------
+// R_WrapColumn
+//  [JN] Column number modulo texture width, see texturewrap_t. Works for
+//  any width and for negative column numbers down to -2^30.
+// -----------------------------------------------------------------------------
+
+static inline int R_WrapColumn (int tex, int col)
+{
+    const texturewrap_t *const wrap = &texturewrap[tex];
+    const unsigned n = (unsigned) col + wrap->bias;
+    const unsigned q = (unsigned) (((uint64_t) n * wrap->magic) >> wrap->shift);
+
+    return n - q * texturewidth[tex];
+}
+
 // -----------------------------------------------------------------------------
 // R_GetColumn
 //  [crispy] wrapping column getter function for any non-power-of-two textures
@@ -491,28 +583,10 @@ static void R_GenerateLookup (int texnum)
 
 byte *R_GetColumn (int tex, int col)
 {
-    const int width = texturewidth[tex];
-    const int mask = texturewidthmask[tex];
-
-    if (mask + 1 == width)
-    {
-        col &= mask;
-    }
-    else
-    {
-        while (col < 0)
-        {
-          col += width;
-        }
-        col %= width;
-    }
-
     if (!texturecomposite2[tex])
         R_GenerateComposite(tex);
 
-    const int ofs = texturecolumnofs2[tex][col];
-
-    return texturecomposite2[tex] + ofs;
+    return COMPOSITE_COLUMNS(texturecomposite2[tex])[R_WrapColumn(tex, col)];
 }
 
 // -----------------------------------------------------------------------------
@@ -522,18 +596,10 @@ byte *R_GetColumn (int tex, int col)
 
 byte *R_GetColumnMod (int tex, int col)
 {
-    int ofs;
-
-    while (col < 0)
-        col += texturewidth[tex];
-
-    col %= texturewidth[tex];
-    ofs = texturecolumnofs[tex][col];
-
     if (!texturecomposite[tex])
         R_GenerateComposite (tex);
 
-    return texturecomposite[tex] + ofs;
+    return COMPOSITE_COLUMNS(texturecomposite[tex])[R_WrapColumn(tex, col)];
 }
 
 // -----------------------------------------------------------------------------
@@ -766,7 +832,7 @@ void R_InitTextures (void)
     texturecomposite     = Z_Malloc(numtextures * sizeof(*texturecomposite),     PU_STATIC, 0);
     texturecomposite2    = Z_Malloc(numtextures * sizeof(*texturecomposite2),    PU_STATIC, 0);
     texturecompositesize = Z_Malloc(numtextures * sizeof(*texturecompositesize), PU_STATIC, 0);
-    texturewidthmask     = Z_Malloc(numtextures * sizeof(*texturewidthmask),     PU_STATIC, 0);
+    texturewrap          = Z_Malloc(numtextures * sizeof(*texturewrap),          PU_STATIC, 0);
     texturewidth         = Z_Malloc(numtextures * sizeof(*texturewidth),         PU_STATIC, 0);
     textureheight        = Z_Malloc(numtextures * sizeof(*textureheight),        PU_STATIC, 0);
     texturebrightmap     = Z_Malloc(numtextures * sizeof(*texturebrightmap),     PU_STATIC, 0);
@@ -843,13 +909,21 @@ void R_InitTextures (void)
         texturecolumnofs[i]  = Z_Malloc(texture->width * sizeof(**texturecolumnofs),  PU_STATIC, 0);
         texturecolumnofs2[i] = Z_Malloc(texture->width * sizeof(**texturecolumnofs2), PU_STATIC, 0);
 
-        int j = 1;
-        while (j * 2 <= texture->width)
+        // [JN] Magic numbers for R_WrapColumn.
         {
-            j <<= 1;
+            const unsigned width = MAX(texture->width, 1);
+            int log2width = 0;
+
+            while ((1u << log2width) < width)
+            {
+                log2width++;
+            }
+
+            texturewrap[i].shift = 32 + log2width;
+            texturewrap[i].magic = ((UINT64_C(1) << texturewrap[i].shift) + width - 1) / width;
+            texturewrap[i].bias  = (0x40000000u / width) * width;
         }
 
-        texturewidthmask[i] = j - 1;
         textureheight[i]    = texture->height << FRACBITS;
 
         // [crispy] texture width for wrapping column getter function
@@ -976,35 +1050,18 @@ void R_InitColormaps (void)
 	{
 		colormaps = (lighttable_t*) Z_Malloc((NUMCOLORMAPS + 1) * 256 * sizeof(lighttable_t), PU_STATIC, 0);
 		invulmaps = (lighttable_t*) Z_Malloc((NUMCOLORMAPS + 1) * 256 * sizeof(lighttable_t), PU_STATIC, 0);
-		R_AllocateColoredColormaps();
 	}
 
-    // [PN] Precompute gamma'ed base RGB for both palettes (once per index)
-    const byte *const restrict gtab = gammatable[vid_gamma];
-    const int gamma_black = gtab[0];
+    // [JN] Colormaps are built without gamma correction, it's applied
+    // to the whole frame when it's uploaded, see I_FinishUpdate.
+    const byte (*const base_render)[3] = (const byte (*)[3]) render_pointer;
+    const byte (*const base_invul)[3] = (const byte (*)[3]) invul_pointer;
     
-    byte base_gamma_render[256][3];
-    byte base_gamma_invul [256][3];
-    
-    for (int p = 0; p < 256; ++p)
-    {
-        // [PN] Render palette (CRYPAL or PLAYPAL)
-        base_gamma_render[p][0] = gtab[render_pointer[3 * p + 0]];
-        base_gamma_render[p][1] = gtab[render_pointer[3 * p + 1]];
-        base_gamma_render[p][2] = gtab[render_pointer[3 * p + 2]];
-    
-        // [PN] Invulnerability palette (CRYINVL or PLAYINVL)
-        base_gamma_invul[p][0]  = gtab[invul_pointer [3 * p + 0]];
-        base_gamma_invul[p][1]  = gtab[invul_pointer [3 * p + 1]];
-        base_gamma_invul[p][2]  = gtab[invul_pointer [3 * p + 2]];
-    }
-    
-    // [PN] Build colormaps with simple gamma-space fade to black
+    // [PN] Build colormaps with simple fade to black
     for (int c = 0; c < NUMCOLORMAPS; ++c)
     {
         const double scale = (double)c / (double)NUMCOLORMAPS;
         const double k0    = 1.0 - scale;          // weight of base color
-        const double kB    = (double)gamma_black * scale; // weight of black (gamma(0))
     
         lighttable_t *const restrict row_col  = &colormaps [c * 256];
         lighttable_t *const restrict row_inv  = &invulmaps [c * 256];
@@ -1014,25 +1071,26 @@ void R_InitColormaps (void)
             const byte k = colormap[i]; // mapping index (identity in your table)
     
             // [PN] Normal colormap (render palette)
-            const int R = (int)(base_gamma_render[k][0] * k0 + kB);
-            const int G = (int)(base_gamma_render[k][1] * k0 + kB);
-            const int B = (int)(base_gamma_render[k][2] * k0 + kB);
+            const int R = (int)(base_render[k][0] * k0);
+            const int G = (int)(base_render[k][1] * k0);
+            const int B = (int)(base_render[k][2] * k0);
     
             row_col[i] = 0xff000000 | ((byte)R << 16) | ((byte)G << 8) | (byte)B;
     
-            // [PN] Colored colormaps generator still expects a linear index.
-            // Use computed absolute index instead of j-counter.
-            R_GenerateColoredColormaps(k, (float)scale, c * 256 + i);
-    
             // [PN] Invulnerability colormap (invul palette)
-            const int Ri = (int)(base_gamma_invul[k][0] * k0 + kB);
-            const int Gi = (int)(base_gamma_invul[k][1] * k0 + kB);
-            const int Bi = (int)(base_gamma_invul[k][2] * k0 + kB);
+            const int Ri = (int)(base_invul[k][0] * k0);
+            const int Gi = (int)(base_invul[k][1] * k0);
+            const int Bi = (int)(base_invul[k][2] * k0);
     
             row_inv[i] = 0xff000000 | ((byte)Ri << 16) | ((byte)Gi << 8) | (byte)Bi;
         }
     }
 
+    // [JN] Colored colormaps and sky strips follow the palette,
+    // generate them again when used.
+    R_FreeColoredLights();
+    R_FreeSkyStrips();
+
 	if (!pal_color)
 	{
 		pal_color = (pixel_t*) Z_Malloc(256 * sizeof(pixel_t), PU_STATIC, 0);
@@ -1040,9 +1098,9 @@ void R_InitColormaps (void)
 
 	for (i = 0, j = 0; i < 256; i++)
 	{
-		r = gammatable[vid_gamma][playpal[3 * i + 0]];
-		g = gammatable[vid_gamma][playpal[3 * i + 1]];
-		b = gammatable[vid_gamma][playpal[3 * i + 2]];
+		r = playpal[3 * i + 0];
+		g = playpal[3 * i + 1];
+		b = playpal[3 * i + 2];
 
 		pal_color[j++] = 0xff000000 | (r << 16) | (g << 8) | b;
 	}
@@ -1054,9 +1112,9 @@ void R_InitColormaps (void)
 
 	for (i = 256, j = 0; i < 512; i++)
 	{
-		r = gammatable[vid_gamma][crypal[3 * i + 0]];
-		g = gammatable[vid_gamma][crypal[3 * i + 1]];
-		b = gammatable[vid_gamma][crypal[3 * i + 2]];
+		r = crypal[3 * i + 0];
+		g = crypal[3 * i + 1];
+		b = crypal[3 * i + 2];
 
 		cry_color[j++] = 0xff000000 | (r << 16) | (g << 8) | b;
 	}
@@ -1126,8 +1184,6 @@ void R_InitData (void)
     printf (".");
     R_InitHSVColors();
     printf (".");
-    I_InitTCTransMaps();
-    printf (".");
 }
 
 // -----------------------------------------------------------------------------
@@ -1208,28 +1264,36 @@ int R_TextureNumForName(const char *name)
 
 #define MAX3(a,b,c) (((a)>(b))?((a)>(c)?(a):(c)):((b)>(c)?(b):(c)))
 
-void R_PrecacheLevel(void)
+// [JN] Every resource is first asked for in the background and only then
+// cached, by then mostly without waiting for the disk. Flats and wall
+// patches are known once the sectors and sidedefs are loaded, so
+// R_PrefetchLevel asks for them while the rest of the map is loaded.
+// Sprites are only known after the things are spawned and are asked for
+// by R_PrecacheLevel itself, in a first pass.
+
+static void R_PrecacheLump (const int lump, const int pass)
 {
-    const size_t maxsize = MAX3(numtextures, numflats, numsprites);
-    byte *restrict hitlist = (byte*)calloc(maxsize, 1);
+    if (pass == 0)
+    {
+        W_PrefetchLumpNum(lump);
+    }
+    else
+    {
+        W_CacheLumpNum(lump, PU_CACHE);
+    }
+}
 
-    // Precache flats
+static void R_MarkLevelFlats (byte *hitlist)
+{
     for (int i = 0; i < numsectors; ++i)
     {
         hitlist[sectors[i].floorpic] = 1;
         hitlist[sectors[i].ceilingpic] = 1;
     }
-    for (int i = 0; i < numflats; ++i)
-    {
-        if (hitlist[i])
-        {
-            W_CacheLumpNum(firstflat + i, PU_CACHE);
-        }
-    }
-
-    memset(hitlist, 0, maxsize);
+}
 
-    // Precache textures
+static void R_MarkLevelTextures (byte *hitlist)
+{
     for (int i = 0; i < numsides; ++i)
     {
         hitlist[sides[i].bottomtexture] = 1;
@@ -1238,7 +1302,21 @@ void R_PrecacheLevel(void)
     }
 
     hitlist[skytexture] = 1;
+}
 
+static void R_PrecacheFlats (const byte *hitlist, const int pass)
+{
+    for (int i = 0; i < numflats; ++i)
+    {
+        if (hitlist[i])
+        {
+            R_PrecacheLump(firstflat + i, pass);
+        }
+    }
+}
+
+static void R_PrecacheTextures (const byte *hitlist, const int pass)
+{
     for (int i = 0; i < numtextures; ++i)
     {
         if (hitlist[i])
@@ -1246,11 +1324,144 @@ void R_PrecacheLevel(void)
             texture_t * const texture = textures[i];
             for (int j = 0; j < texture->patchcount; ++j)
             {
-                W_CacheLumpNum(texture->patches[j].patch, PU_CACHE);
+                R_PrecacheLump(texture->patches[j].patch, pass);
+            }
+        }
+    }
+}
+
+// [JN] Composite the given textures on the worker threads, rather than
+// when they are first drawn. The zone memory is only touched before and
+// after the parallel part.
+//
+// Everything a batch uses is PU_STATIC until the batch is finished, so
+// textures are composited in batches of about COMPOSITE_BATCH_BYTES of
+// composites and patches. After each batch, its composites and patches
+// are dropped to PU_CACHE and can be purged by the next one.
+
+#define COMPOSITE_BATCH_BYTES (8 * 1024 * 1024)
+
+typedef struct
+{
+    int texnum;
+    const patch_t **patches;
+} compositejob_t;
+
+static void R_CompositeJob (int index, void *data)
+{
+    const compositejob_t *const job = (const compositejob_t *) data + index;
+
+    R_BuildComposite(job->texnum, job->patches);
+}
+
+// Bytes of zone memory held while a texture is composited. Patches shared
+// between textures are counted for each of them.
+
+static size_t R_CompositeBytes (int texnum)
+{
+    const texture_t *const texture = textures[texnum];
+    const size_t columns = (size_t)texture->width * sizeof(byte *);
+    size_t bytes = 2 * columns + texturecompositesize[texnum]
+                 + (size_t)texture->width * (size_t)texture->height;
+
+    for (int i = 0; i < texture->patchcount; ++i)
+    {
+        bytes += W_LumpLength(texture->patches[i].patch);
+    }
+
+    return bytes;
+}
+
+static void R_FinishCompositeBatch (compositejob_t *jobs, int numjobs)
+{
+    I_ParallelFor(numjobs, R_CompositeJob, jobs);
+
+    for (int i = 0; i < numjobs; ++i)
+    {
+        R_FinishComposite(jobs[i].texnum, jobs[i].patches);
+    }
+}
+
+static void R_PrecacheComposites (const byte *hitlist)
+{
+    compositejob_t *const jobs = malloc(numtextures * sizeof(*jobs));
+    size_t batchbytes = 0;
+    int numjobs = 0;
+
+    if (jobs == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < numtextures; ++i)
+    {
+        if (hitlist[i] && !texturecomposite[i] && !texturecomposite2[i])
+        {
+            const size_t bytes = R_CompositeBytes(i);
+
+            if (numjobs > 0 && batchbytes + bytes > COMPOSITE_BATCH_BYTES)
+            {
+                R_FinishCompositeBatch(jobs, numjobs);
+                batchbytes = 0;
+                numjobs = 0;
             }
+
+            jobs[numjobs].texnum = i;
+            jobs[numjobs].patches = R_AllocComposite(i);
+            batchbytes += bytes;
+            ++numjobs;
         }
     }
 
+    R_FinishCompositeBatch(jobs, numjobs);
+
+    free(jobs);
+}
+
+// -----------------------------------------------------------------------------
+// R_PrefetchLevel
+// [JN] Start reading the level's flats and wall patches in the background.
+//      Called by P_SetupLevel as soon as the sectors and sidedefs are loaded.
+// -----------------------------------------------------------------------------
+
+void R_PrefetchLevel (void)
+{
+    const size_t maxsize = MAX(numtextures, numflats);
+    byte *restrict hitlist = (byte*)calloc(maxsize, 1);
+
+    if (hitlist == NULL)
+    {
+        return;
+    }
+
+    R_MarkLevelFlats(hitlist);
+    R_PrecacheFlats(hitlist, 0);
+
+    memset(hitlist, 0, maxsize);
+
+    R_MarkLevelTextures(hitlist);
+    R_PrecacheTextures(hitlist, 0);
+
+    free(hitlist);
+}
+
+void R_PrecacheLevel(void)
+{
+    const size_t maxsize = MAX3(numtextures, numflats, numsprites);
+    byte *restrict hitlist = (byte*)calloc(maxsize, 1);
+
+    // Precache flats
+    R_MarkLevelFlats(hitlist);
+    R_PrecacheFlats(hitlist, 1);
+
+    memset(hitlist, 0, maxsize);
+
+    // Precache textures
+    R_MarkLevelTextures(hitlist);
+    R_PrecacheTextures(hitlist, 1);
+
+    R_PrecacheComposites(hitlist);
+
     memset(hitlist, 0, maxsize);
 
     // Precache sprites
@@ -1262,6 +1473,7 @@ void R_PrecacheLevel(void)
         }
     }
 
+    for (int pass = 0; pass < 2; ++pass)
     for (int i = 0; i < numsprites; ++i)
     {
         if (hitlist[i])
@@ -1271,7 +1483,7 @@ void R_PrecacheLevel(void)
                 const short *sflump = sprites[i].spriteframes[j].lump;
                 for (int k = 0; k < 8; ++k)
                 {
-                    W_CacheLumpNum(firstspritelump + sflump[k], PU_CACHE);
+                    R_PrecacheLump(firstspritelump + sflump[k], pass);
                 }
             }
         }
@@ -68,6 +68,17 @@ byte translations[3][256];
 
 static pixel_t *background_buffer = NULL;
 
+// [JN] Lumps of the bezel pattern and border.
+
+static lumphandle_t lump_floor7_1 = LUMPHANDLE("FLOOR7_1");
+static lumphandle_t lump_brdr[8] =
+{
+    LUMPHANDLE("brdr_t"),  LUMPHANDLE("brdr_b"),
+    LUMPHANDLE("brdr_l"),  LUMPHANDLE("brdr_r"),
+    LUMPHANDLE("brdr_tl"), LUMPHANDLE("brdr_tr"),
+    LUMPHANDLE("brdr_bl"), LUMPHANDLE("brdr_br"),
+};
+
 
 //
 // R_DrawColumn
@@ -252,9 +263,39 @@ void R_SetFuzzPosTic (void)
 	}
 	fuzzpos_tic = fuzzpos;
 }
+
+// [JN] Rows to sample from, premultiplied by the screen pitch. The table
+// is repeated for the height of the screen, so a column indexes it from
+// fuzzpos without wrapping around. Rebuilt when the pitch changes.
+static int fuzzmask[FUZZTABLE + MAXHEIGHT];
+static int fuzzmask_pitch;
+
+static void R_InitFuzzMask (void)
+{
+	for (int i = 0; i < FUZZTABLE + MAXHEIGHT; ++i)
+	{
+		fuzzmask[i] = SCREENWIDTH * fuzzoffset[i % FUZZTABLE];
+	}
+	fuzzmask_pitch = SCREENWIDTH;
+}
+
 void R_SetFuzzPosDraw (void)
 {
 	fuzzpos = fuzzpos_tic;
+
+	if (fuzzmask_pitch != SCREENWIDTH)
+	{
+		R_InitFuzzMask();
+	}
+}
+
+// [JN] Sample for the first pixel of a fuzz column. The top row of the
+// screen has no row above, take the last pixel of the same row instead.
+// Below it the cutoff guarantees a row to sample, so the rest of the
+// column reads dest[mask[i]] without any checks.
+static inline const pixel_t *R_FuzzTopSource (pixel_t *dest, int offset)
+{
+	return (dest + offset < I_VideoBuffer) ? dest + SCREENWIDTH - 1 : dest + offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -287,14 +328,10 @@ void R_DrawFuzzColumn(void)
     pixel_t *restrict dest = ylookup[dc_yl] + columnofs[flipviewwidth[dc_x]];
 
     // Local pointers to improve memory access
-    const int *restrict const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    const int *restrict const mask = fuzzmask + fuzzpos;
     const int pitch = SCREENWIDTH;
-    const int top_delta = pitch - 1;
-    const pixel_t *restrict const vbuf_start = I_VideoBuffer;
-    const pixel_t *restrict const vbuf_end = I_VideoBuffer + SCREENAREA;
-    const int fuzzwrap = FUZZTABLE;
     const int block = (vid_resolution > 1) ? vid_resolution : 1;
+    const int iterations = count + 1;
 
     // --- Blocky mode for hi-res ---
     if (block > 1)
@@ -311,42 +348,32 @@ void R_DrawFuzzColumn(void)
 
         // Lines to align with vertical block grid
         int lines = block - (dc_yl % block);
-        int remaining = count + 1;
+        int remaining = iterations;
+        int blocks = 0;
 
         while (remaining > 0)
         {
             int write_lines = lines;
             if (write_lines > remaining) write_lines = remaining;
 
-            // Sample source (one row up/down per fuzzoffset)
-            const int off = pitch * fuzzoffsetbase[local_fuzzpos];
-            const pixel_t *restrict src = dest + off;
+            // Sample source (one row up/down per fuzz mask)
+            const pixel_t *restrict src = blocks ? dest + mask[blocks]
+                                                 : R_FuzzTopSource(dest, mask[0]);
+            const pixel_t blended = I_BlendDark_32(*src, 0xD3); // 211 (17% darkening)
 
-            // Clamp against top, then in-bounds guard
-            if (src < vbuf_start) src = dest + top_delta;
-            if (src < vbuf_end)
+            // Fill rectangle: write_lines × fuzzblockwidth
+            pixel_t *row = dest;
+            for (int ly = 0; ly < write_lines; ++ly)
             {
-                const pixel_t blended = I_BlendDark_32(*src, 0xD3); // 211 (17% darkening)
-
-                // Fill rectangle: write_lines × fuzzblockwidth
-                pixel_t *row = dest;
-                for (int ly = 0; ly < write_lines; ++ly)
-                {
-                    for (int j = 0; j < fuzzblockwidth; ++j)
-                        row[j] = blended;
-                    row += pitch;
-                }
+                for (int j = 0; j < fuzzblockwidth; ++j)
+                    row[j] = blended;
+                row += pitch;
             }
 
             // Advance vertically
             remaining -= write_lines;
             dest += pitch * write_lines;
-
-            // Update fuzz position (compact wrap & optional jitter)
-            if (++local_fuzzpos == fuzzwrap)
-            {
-                local_fuzzpos = 0;
-            }
+            ++blocks;
 
             lines = block;
         }
@@ -354,45 +381,34 @@ void R_DrawFuzzColumn(void)
         // Bottom cutoff: one extra strip
         if (cutoff)
         {
-            const int fuzz_off = pitch * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+            const int fuzz_off = (mask[blocks] - pitch) / 2;
             const pixel_t blended = I_BlendDark_32(dest[fuzz_off], 0xD3); // 211 (17% darkening)
             for (int j = 0; j < fuzzblockwidth; ++j)
                 dest[j] = blended;
         }
 
-        fuzzpos = local_fuzzpos;
+        fuzzpos = (fuzzpos + blocks) % FUZZTABLE;
         return;
     }
 
     // --- Classic path for vid_resolution == 1 ---
-    int iterations = count + 1;
-    while (iterations--)
-    {
-        const int offset = pitch * fuzzoffsetbase[local_fuzzpos];
-        const pixel_t *restrict src = dest + offset;
-
-        // Top clamp + in-bounds guard
-        if (src < vbuf_start) src = dest + top_delta;
-        if (src < vbuf_end)
-            *dest = I_BlendDark_32(*src, 0xD3); // 211 (17% darkening)
-
-        // Update fuzz position (compact wrap & optional jitter)
-        if (++local_fuzzpos == fuzzwrap)
-        {
-            local_fuzzpos = 0;
-        }
+    *dest = I_BlendDark_32(*R_FuzzTopSource(dest, mask[0]), 0xD3); // 211 (17% darkening)
+    dest += pitch;
 
+    for (int i = 1; i < iterations; ++i)
+    {
+        *dest = I_BlendDark_32(dest[mask[i]], 0xD3); // 211 (17% darkening)
         dest += pitch;
     }
 
     // Bottom cutoff
     if (cutoff)
     {
-        const int fuzz_offset = pitch * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+        const int fuzz_offset = (mask[iterations] - pitch) / 2;
         *dest = I_BlendDark_32(dest[fuzz_offset], 0xD3); // 211 (17% darkening)
     }
 
-    fuzzpos = local_fuzzpos;
+    fuzzpos = (fuzzpos + iterations) % FUZZTABLE;
 }
 
 // -----------------------------------------------------------------------------
@@ -427,15 +443,10 @@ void R_DrawFuzzColumnLow(void)
     pixel_t *restrict dest2 = ylookup[dc_yl] + columnofs[flipviewwidth[x + 1]];
 
     // Hoisted constants and caches
-    const int *restrict const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
-
+    const int *restrict const mask = fuzzmask + fuzzpos;
     const int pitch = SCREENWIDTH;
-    const int top_delta = pitch - 1;
-    const pixel_t *restrict const vbuf_start = I_VideoBuffer;
-    const pixel_t *restrict const vbuf_end   = I_VideoBuffer + SCREENAREA;
-    const int fuzzwrap = FUZZTABLE;
     const int block = (vid_resolution > 1) ? vid_resolution : 1;
+    const int iterations = count + 1;
 
     // --- Blocky mode for hi-res: draw rectangles aligned to the grid ---
     if (block > 1)
@@ -464,44 +475,32 @@ void R_DrawFuzzColumnLow(void)
 
         // Lines to align with vertical block grid
         int lines = block - (dc_yl % block);
-        int remaining = count + 1;
+        int remaining = iterations;
+        int blocks = 0;
 
         while (remaining > 0)
         {
             int write_lines = lines;
             if (write_lines > remaining) write_lines = remaining;
 
-            // Sample source (one row up/down per fuzzoffset)
-            const int off = pitch * fuzzoffsetbase[local_fuzzpos];
-            const pixel_t *restrict src = draw + off;
+            // Sample source (one row up/down per fuzz mask)
+            const pixel_t *restrict src = blocks ? draw + mask[blocks]
+                                                 : R_FuzzTopSource(draw, mask[0]);
+            const pixel_t blended = I_BlendDark_32(*src, 0xD3); // 211 (17% darkening)
 
-            // Top clamp + in-bounds guard
-            if (src < vbuf_start) src = draw + top_delta;
-            if (src < vbuf_end)
+            // Fill rectangle: write_lines × fuzzblockwidth (anchored)
+            pixel_t *row = draw;
+            for (int ly = 0; ly < write_lines; ++ly)
             {
-                const pixel_t blended = I_BlendDark_32(*src, 0xD3); // 211 (17% darkening)
-
-                // Fill rectangle: write_lines × fuzzblockwidth (anchored)
-                pixel_t *row = draw;
-                for (int ly = 0; ly < write_lines; ++ly)
-                {
-                    for (int j = 0; j < fuzzblockwidth; ++j)
-                        row[j] = blended;
-                    row += pitch;
-                }
+                for (int j = 0; j < fuzzblockwidth; ++j)
+                    row[j] = blended;
+                row += pitch;
             }
 
-            // Advance vertically; keep dest/dest2 in step for classic cutoff data
+            // Advance vertically
             remaining -= write_lines;
-            draw  += pitch * write_lines;
-            dest  += pitch * write_lines;
-            dest2 += pitch * write_lines;
-
-            // Update fuzzpos (compact wrap & optional jitter)
-            if (++local_fuzzpos == fuzzwrap)
-            {
-                local_fuzzpos = 0;
-            }
+            draw += pitch * write_lines;
+            ++blocks;
 
             lines = block;
         }
@@ -509,40 +508,26 @@ void R_DrawFuzzColumnLow(void)
         // Bottom cutoff: one extra strip at the anchor
         if (cutoff)
         {
-            const int fuzz_off = pitch * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+            const int fuzz_off = (mask[blocks] - pitch) / 2;
             const pixel_t blended = I_BlendDark_32(draw[fuzz_off], 0xD3); // 211 (17% darkening)
             for (int j = 0; j < fuzzblockwidth; ++j)
                 draw[j] = blended;
         }
 
-        fuzzpos = local_fuzzpos;
+        fuzzpos = (fuzzpos + blocks) % FUZZTABLE;
         return;
     }
 
     // --- Classic path for vid_resolution == 1 (two physical columns) ---
-    int iterations = count + 1;
-    while (iterations--)
-    {
-        const int off = pitch * fuzzoffsetbase[local_fuzzpos];
-
-        const pixel_t *restrict src1 = dest  + off;
-        const pixel_t *restrict src2 = dest2 + off;
-
-        // Top clamp + in-bounds guard
-        if (src1 < vbuf_start) src1 = dest  + top_delta;
-        if (src2 < vbuf_start) src2 = dest2 + top_delta;
-
-        if (src1 < vbuf_end)
-            *dest = I_BlendDark_32(*src1, 0xD3); // 211 (17% darkening)
-        if (src2 < vbuf_end)
-            *dest2 = I_BlendDark_32(*src2, 0xD3); // 211 (17% darkening)
-
-        // Update fuzzpos (compact wrap & optional jitter)
-        if (++local_fuzzpos == fuzzwrap)
-        {
-            local_fuzzpos = 0;
-        }
+    *dest  = I_BlendDark_32(*R_FuzzTopSource(dest,  mask[0]), 0xD3); // 211 (17% darkening)
+    *dest2 = I_BlendDark_32(*R_FuzzTopSource(dest2, mask[0]), 0xD3); // 211 (17% darkening)
+    dest  += pitch;
+    dest2 += pitch;
 
+    for (int i = 1; i < iterations; ++i)
+    {
+        *dest  = I_BlendDark_32(dest [mask[i]], 0xD3); // 211 (17% darkening)
+        *dest2 = I_BlendDark_32(dest2[mask[i]], 0xD3); // 211 (17% darkening)
         dest  += pitch;
         dest2 += pitch;
     }
@@ -550,13 +535,13 @@ void R_DrawFuzzColumnLow(void)
     // Bottom cutoff (classic)
     if (cutoff)
     {
-        const int fuzz_offset = pitch * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+        const int fuzz_offset = (mask[iterations] - pitch) / 2;
         *dest  = I_BlendDark_32(dest [fuzz_offset], 0xD3); // 211 (17% darkening)
         *dest2 = I_BlendDark_32(dest2[fuzz_offset], 0xD3); // 211 (17% darkening)
     }
 
     // Persist fuzz position
-    fuzzpos = local_fuzzpos;
+    fuzzpos = (fuzzpos + iterations) % FUZZTABLE;
 }
 
 // -----------------------------------------------------------------------------
@@ -649,15 +634,12 @@ void R_DrawFuzzTLColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        // Process two lines for both columns
-        const pixel_t blended = I_BlendOver64_32(*dest1, destrgb);
-        dest1[0] = blended;
-        dest1[screenwidth] = blended;
-        
-        const pixel_t blended2 = I_BlendOver64_32(*dest2, destrgb);
-        dest2[0] = blended2;
-        dest2[screenwidth] = blended2;
+
+        // Blend both columns at once, write them to two lines
+        const uint64_t blended = I_BlendOver64_32x2(I_PackPair_32(*dest1, *dest2),
+                                                    I_SplatPair_32(destrgb));
+        dest1[0] = dest1[screenwidth] = (pixel_t) blended;
+        dest2[0] = dest2[screenwidth] = (pixel_t) (blended >> 32);
 
         // Move to next pair of lines
         dest1 += screenwidth * step;
@@ -671,9 +653,11 @@ void R_DrawFuzzTLColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        dest1[0] = I_BlendOver64_32(*dest1, destrgb);
-        dest2[0] = I_BlendOver64_32(*dest2, destrgb);
+        const uint64_t blended = I_BlendOver64_32x2(I_PackPair_32(*dest1, *dest2),
+                                                    I_SplatPair_32(destrgb));
+
+        dest1[0] = (pixel_t) blended;
+        dest2[0] = (pixel_t) (blended >> 32);
     }
 }
 
@@ -696,41 +680,28 @@ void R_DrawFuzzBWColumn(void)
     pixel_t *restrict dest = ylookup[dc_yl] + columnofs[flipviewwidth[dc_x]];
 
     // Local pointers for improved memory access
-    const int *restrict const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    const int *restrict const mask = fuzzmask + fuzzpos;
     const int screenwidth = SCREENWIDTH;
-    const pixel_t *restrict const vbuf_start = I_VideoBuffer;
-    const pixel_t *restrict const vbuf_end = I_VideoBuffer + SCREENAREA;
-
-    // Aggressive optimization: reduce overhead in loop
     const int iterations = count + 1;
-    for (int i = 0; i < iterations; ++i)
-    {
-        const int offset = screenwidth * fuzzoffsetbase[local_fuzzpos];
-        const pixel_t *restrict src = dest + offset;
-
-        // Safely inject horizontal randomness
-        src = (src < vbuf_start) ? dest + screenwidth - 1 : src;
-
-        if (src < vbuf_end)
-            *dest = I_BlendDarkGrayscale_32(*src, 0xD3); // 211 (17% darkening)
 
-        // Update fuzz position aggressively
-        if (++local_fuzzpos == FUZZTABLE)
-            local_fuzzpos = 0;
+    *dest = I_BlendDarkGrayscale_32(*R_FuzzTopSource(dest, mask[0]), 0xD3); // 211 (17% darkening)
+    dest += screenwidth;
 
+    for (int i = 1; i < iterations; ++i)
+    {
+        *dest = I_BlendDarkGrayscale_32(dest[mask[i]], 0xD3); // 211 (17% darkening)
         dest += screenwidth; // Advance destination pointer
     }
 
     // Handle cutoff line
     if (cutoff)
     {
-        const int fuzz_offset = screenwidth * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+        const int fuzz_offset = (mask[iterations] - screenwidth) / 2;
         *dest = I_BlendDarkGrayscale_32(dest[fuzz_offset], 0xD3); // 211 (17% darkening)
     }
 
     // Restore fuzz position
-    fuzzpos = local_fuzzpos;
+    fuzzpos = (fuzzpos + iterations) % FUZZTABLE;
 }
 
 // -----------------------------------------------------------------------------
@@ -756,33 +727,19 @@ void R_DrawFuzzBWColumnLow(void)
     pixel_t *restrict dest2 = ylookup[dc_yl] + columnofs[flipviewwidth[x + 1]];
 
     // Local pointers for improved memory access
-    const int *restrict const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    const int *restrict const mask = fuzzmask + fuzzpos;
     const int screenwidth = SCREENWIDTH;
-    const pixel_t *restrict const vbuf_start = I_VideoBuffer;
-    const pixel_t *restrict const vbuf_end = I_VideoBuffer + SCREENAREA;
-
-    // Loop for blending pixels with aggressive optimizations
     const int iterations = count + 1;
-    for (int i = 0; i < iterations; ++i)
-    {
-        const int offset = screenwidth * fuzzoffsetbase[local_fuzzpos];
-        const pixel_t *restrict src1 = dest + offset;
-        const pixel_t *restrict src2 = dest2 + offset;
 
-        // Safely inject horizontal randomness
-        src1 = (src1 < vbuf_start) ? dest + screenwidth - 1 : src1;
-        src2 = (src2 < vbuf_start) ? dest2 + screenwidth - 1 : src2;
-
-        if (src1 < vbuf_end)
-            *dest = I_BlendDarkGrayscale_32(*src1, 0xD3); // 211 (17% darkening)
-        if (src2 < vbuf_end)
-            *dest2 = I_BlendDarkGrayscale_32(*src2, 0xD3); // 211 (17% darkening)
-
-        // Update fuzz position efficiently
-        if (++local_fuzzpos == FUZZTABLE)
-            local_fuzzpos = 0;
+    *dest = I_BlendDarkGrayscale_32(*R_FuzzTopSource(dest, mask[0]), 0xD3); // 211 (17% darkening)
+    *dest2 = I_BlendDarkGrayscale_32(*R_FuzzTopSource(dest2, mask[0]), 0xD3); // 211 (17% darkening)
+    dest += screenwidth;
+    dest2 += screenwidth;
 
+    for (int i = 1; i < iterations; ++i)
+    {
+        *dest = I_BlendDarkGrayscale_32(dest[mask[i]], 0xD3); // 211 (17% darkening)
+        *dest2 = I_BlendDarkGrayscale_32(dest2[mask[i]], 0xD3); // 211 (17% darkening)
         dest += screenwidth;
         dest2 += screenwidth;
     }
@@ -790,14 +747,14 @@ void R_DrawFuzzBWColumnLow(void)
     // Handle cutoff line
     if (cutoff)
     {
-        const int fuzz_offset = screenwidth * (fuzzoffsetbase[local_fuzzpos] - FUZZOFF) / 2;
+        const int fuzz_offset = (mask[iterations] - screenwidth) / 2;
 
         *dest = I_BlendDarkGrayscale_32(dest[fuzz_offset], 0xD3); // 211 (17% darkening)
         *dest2 = I_BlendDarkGrayscale_32(dest2[fuzz_offset], 0xD3); // 211 (17% darkening)
     }
 
     // Restore fuzz position
-    fuzzpos = local_fuzzpos;
+    fuzzpos = (fuzzpos + iterations) % FUZZTABLE;
 }
 
 // -----------------------------------------------------------------------------
@@ -872,9 +829,11 @@ void R_DrawTransTLFuzzColumnLow(void)
         const unsigned s = sourcebase[frac >> FRACBITS];   // Texture sample
         const pixel_t destrgb = colormap0[translation[s]]; // Translation + colormap lookup
 
-        // Blend operation inline
-        *dest = I_BlendOver64_32(*dest, destrgb);
-        *dest2 = I_BlendOver64_32(*dest2, destrgb);
+        // Blend both columns at once
+        const uint64_t blended = I_BlendOver64_32x2(I_PackPair_32(*dest, *dest2),
+                                                    I_SplatPair_32(destrgb));
+        *dest = (pixel_t) blended;
+        *dest2 = (pixel_t) (blended >> 32);
 
         // Advance destination pointers and texture coordinate
         dest += screenwidth;
@@ -1061,15 +1020,12 @@ void R_DrawTLColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        // Process two lines for both columns
-        const pixel_t blended = I_BlendOver168_32(*dest1, destrgb);
-        dest1[0] = blended;
-        dest1[screenwidth] = blended;
-        
-        const pixel_t blended2 = I_BlendOver168_32(*dest2, destrgb);
-        dest2[0] = blended2;
-        dest2[screenwidth] = blended2;
+
+        // Blend both columns at once, write them to two lines
+        const uint64_t blended = I_BlendOver168_32x2(I_PackPair_32(*dest1, *dest2),
+                                                     I_SplatPair_32(destrgb));
+        dest1[0] = dest1[screenwidth] = (pixel_t) blended;
+        dest2[0] = dest2[screenwidth] = (pixel_t) (blended >> 32);
 
         // Move to next pair of lines
         dest1 += screenwidth * step;
@@ -1083,9 +1039,11 @@ void R_DrawTLColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        dest1[0] = I_BlendOver168_32(*dest1, destrgb);
-        dest2[0] = I_BlendOver168_32(*dest2, destrgb);
+        const uint64_t blended = I_BlendOver168_32x2(I_PackPair_32(*dest1, *dest2),
+                                                     I_SplatPair_32(destrgb));
+
+        dest1[0] = (pixel_t) blended;
+        dest2[0] = (pixel_t) (blended >> 32);
     }
 }
 
@@ -1180,15 +1138,12 @@ void R_DrawTLAddColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        // Process two lines for both columns
-        const pixel_t blended = I_BlendAdd_32(*dest1, destrgb);
-        dest1[0] = blended;
-        dest1[screenwidth] = blended;
-        
-        const pixel_t blended2 = I_BlendAdd_32(*dest2, destrgb);
-        dest2[0] = blended2;
-        dest2[screenwidth] = blended2;
+
+        // Blend both columns at once, write them to two lines
+        const uint64_t blended = I_BlendAdd_32x2(I_PackPair_32(*dest1, *dest2),
+                                                 I_SplatPair_32(destrgb));
+        dest1[0] = dest1[screenwidth] = (pixel_t) blended;
+        dest2[0] = dest2[screenwidth] = (pixel_t) (blended >> 32);
 
         // Move to next pair of lines
         dest1 += screenwidth * step;
@@ -1202,9 +1157,11 @@ void R_DrawTLAddColumnLow(void)
     {
         const unsigned s = sourcebase[frac >> FRACBITS];
         const pixel_t destrgb = brightmap[s] ? colormap1[s] : colormap0[s];
-        
-        dest1[0] = I_BlendAdd_32(*dest1, destrgb);
-        dest2[0] = I_BlendAdd_32(*dest2, destrgb);
+        const uint64_t blended = I_BlendAdd_32x2(I_PackPair_32(*dest1, *dest2),
+                                                 I_SplatPair_32(destrgb));
+
+        dest1[0] = (pixel_t) blended;
+        dest2[0] = (pixel_t) (blended >> 32);
     }
 }
 
@@ -1506,6 +1463,19 @@ void R_InitBuffer (int width, int height)
     }
 }
 
+// -----------------------------------------------------------------------------
+// R_RelocateBuffer
+// [JN] The screen buffer has moved, point the row offsets to it again.
+// -----------------------------------------------------------------------------
+
+void R_RelocateBuffer (void)
+{
+    for (int i = 0; i < viewheight; i++)
+    {
+        ylookup[i] = I_VideoBuffer + (i + viewwindowy) * SCREENWIDTH;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // R_FillBackScreen
 // Fills the back screen with a pattern for variable screen sizes.
@@ -1535,18 +1505,18 @@ void R_FillBackScreen (void)
 
     // [PN] Cache the background texture and fill the screen
     // [JN] Jaguar Doom border patch.
-    const byte *src = W_CacheLumpName("FLOOR7_1", PU_CACHE);
+    const byte *src = W_CacheLumpHandle(&lump_floor7_1, PU_CACHE);
     pixel_t *dest = background_buffer;
 
     // [PN] Pre-cache patches for border drawing
-    patch_t *patch_top = W_CacheLumpName("brdr_t", PU_CACHE);
-    patch_t *patch_bottom = W_CacheLumpName("brdr_b", PU_CACHE);
-    patch_t *patch_left = W_CacheLumpName("brdr_l", PU_CACHE);
-    patch_t *patch_right = W_CacheLumpName("brdr_r", PU_CACHE);
-    patch_t *patch_tl = W_CacheLumpName("brdr_tl", PU_CACHE);
-    patch_t *patch_tr = W_CacheLumpName("brdr_tr", PU_CACHE);
-    patch_t *patch_bl = W_CacheLumpName("brdr_bl", PU_CACHE);
-    patch_t *patch_br = W_CacheLumpName("brdr_br", PU_CACHE);
+    patch_t *patch_top = W_CacheLumpHandle(&lump_brdr[0], PU_CACHE);
+    patch_t *patch_bottom = W_CacheLumpHandle(&lump_brdr[1], PU_CACHE);
+    patch_t *patch_left = W_CacheLumpHandle(&lump_brdr[2], PU_CACHE);
+    patch_t *patch_right = W_CacheLumpHandle(&lump_brdr[3], PU_CACHE);
+    patch_t *patch_tl = W_CacheLumpHandle(&lump_brdr[4], PU_CACHE);
+    patch_t *patch_tr = W_CacheLumpHandle(&lump_brdr[5], PU_CACHE);
+    patch_t *patch_bl = W_CacheLumpHandle(&lump_brdr[6], PU_CACHE);
+    patch_t *patch_br = W_CacheLumpHandle(&lump_brdr[7], PU_CACHE);
 
     // [PN] Precompute commonly used values
     const int viewx = viewwindowx / vid_resolution;
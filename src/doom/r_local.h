@@ -138,6 +138,9 @@ typedef	struct
     fixed_t	interpfloorheight;
     fixed_t	interpceilingheight;
 
+    // [JN] In the list of sectors to interpolate, see R_AddInterpSector.
+    boolean	interplisted;
+
     // [crispy] revealed secrets
     short	oldspecial;
 } sector_t;
@@ -503,14 +506,15 @@ typedef struct localview_s
 extern fixed_t viewx;
 extern fixed_t viewy;
 extern fixed_t viewz;
+extern fixed_t viewmobjz;
 
 extern angle_t   viewangle;
 extern player_t *viewplayer;
 extern localview_t localview; // [crispy]
 
-extern int      viewangletox[FINEANGLES/2];
-extern angle_t  xtoviewangle[MAXWIDTH+1];
-extern angle_t  linearskyangle[MAXWIDTH+1];
+extern int     *viewangletox;
+extern angle_t *xtoviewangle;
+extern angle_t *linearskyangle;
 extern fixed_t  rw_distance;
 extern angle_t  rw_normalangle;
 extern angle_t  clipangle;
@@ -537,8 +541,11 @@ extern const byte **texturebrightmap;
 
 typedef void (*drawfunc_t) (int start, int stop);
 
+extern void R_AddInterpSector (sector_t *sector);
 extern void R_ClearClipSegs (void);
 extern void R_ClearDrawSegs (void);
+extern void R_ClearInterpSectors (void);
+extern void R_InterpolateSectors (void);
 extern void R_RenderBSPNode (int bspnum);
 
 extern seg_t    *curline;
@@ -569,6 +576,7 @@ extern int   R_TextureNumForName (const char *name);
 extern void  R_InitColormaps (void);
 extern void  R_InitData (void);
 extern void  R_PrecacheLevel (void);
+extern void  R_PrefetchLevel (void);
 
 extern int   *texturecompositesize;
 extern byte **texturecomposite;
@@ -601,6 +609,7 @@ extern void R_DrawTransTLFuzzColumnLow (void);
 extern void R_DrawViewBorder (void);
 extern void R_FillBackScreen (void);
 extern void R_InitBuffer (int width, int height);
+extern void R_RelocateBuffer (void);
 extern void R_InitTranslationTables (void);
 extern void R_SetFuzzPosDraw (void);
 extern void R_SetFuzzPosTic (void);
@@ -638,8 +647,10 @@ extern const byte *ds_brightmap;
 extern void    R_ExecuteSetViewSize (void);
 extern void    R_Init (void);
 extern void    R_InitLightTables (void);
+extern void    R_QueueSetViewSize (void);
 extern void    R_RenderPlayerView (player_t *player);
 extern void    R_SetViewSize (int blocks, int detail);
+extern boolean R_SwapViewSize (void);
 
 // Utility functions.
 extern angle_t R_PointToAngle (fixed_t x, fixed_t y);
@@ -760,6 +771,7 @@ extern int detailshift;
 
 extern void R_ClearPlanes (void);
 extern void R_DrawPlanes (void);
+extern void R_FreeSkyStrips (void);
 extern void R_InitPlanes (void);
 
 extern int  floorclip[MAXWIDTH];    // [JN] 32-bit integer math
@@ -770,8 +782,8 @@ extern int    *lastopening;
 extern int    *openings;
 
 extern fixed_t *yslope;
-extern fixed_t  yslopes[LOOKDIRS][MAXHEIGHT];
-extern fixed_t distscale[MAXWIDTH];
+extern fixed_t (*yslopes)[MAXHEIGHT];
+extern fixed_t *distscale;
 
 extern fixed_t swirlCoord_x;
 extern fixed_t swirlCoord_y;
@@ -26,6 +26,7 @@
 #include "doomstat.h" // [AM] leveltime, paused, menuactive
 #include "m_bbox.h"
 #include "d_main.h"
+#include "i_thread.h"
 #include "m_menu.h"
 #include "p_local.h"
 #include "v_video.h"
@@ -60,6 +61,7 @@ fixed_t			projection;
 fixed_t			viewx;
 fixed_t			viewy;
 fixed_t			viewz;
+fixed_t			viewmobjz; // [JN] Feet of the view mobj, for sounds
 
 angle_t			viewangle;
 localview_t		localview; // [crispy]
@@ -81,15 +83,16 @@ angle_t			clipangle;
 // maps the visible view angles to screen X coordinates,
 // flattening the arc to a flat projection plane.
 // There will be many angles mapped to the same X. 
-int			viewangletox[FINEANGLES/2];
+// [JN] Points into the live set of view tables, see R_ExecuteSetViewSize.
+int			*viewangletox;
 
 // The xtoviewangleangle[] table maps a screen pixel
 // to the lowest viewangle that maps back to x ranges
 // from clipangle to -clipangle.
-angle_t			xtoviewangle[MAXWIDTH+1];
+angle_t			*xtoviewangle;
 
 // [crispy] calculate the linear sky angle component here
-angle_t			linearskyangle[MAXWIDTH+1];
+angle_t			*linearskyangle;
 
 // [crispy] parameterized for smooth diminishing lighting
 lighttable_t***		scalelight = NULL;
@@ -368,82 +371,129 @@ static int scaledviewwidth_nonwide;
 int viewwidth_nonwide;  // [JN] Externalized for colored lighting.
 static fixed_t centerxfrac_nonwide;
 
+// -----------------------------------------------------------------------------
+// View tables
+//  [JN] The tables depending on the view size are built into a shadow
+//  set, which replaces the live one between frames. When the size
+//  changes mid-game, the set is built on a background thread and the
+//  view is drawn at the old size until it is ready, see R_QueueSetViewSize.
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    int     scaledviewwidth;
+    int     scaledviewwidth_nonwide;
+    int     viewheight;
+    int     detailshift;
+    int     viewwidth;
+    int     viewwidth_nonwide;
+    fixed_t centerxfrac;
+    fixed_t centerxfrac_nonwide;
+    fixed_t fovscale;
+    float   fovdiff;
+
+    // Settings the size was worked out with.
+    int     screenwidth;
+    int     screenheight;
+    int     nonwidewidth;
+    int     resolution;
+    int     screen_size;
+    int     fov;
+} viewsize_t;
+
+typedef struct
+{
+    int     viewangletox[FINEANGLES/2];
+    angle_t xtoviewangle[MAXWIDTH+1];
+    angle_t linearskyangle[MAXWIDTH+1];
+    fixed_t distscale[MAXWIDTH];
+    fixed_t yslopes[LOOKDIRS][MAXHEIGHT];
+    angle_t clipangle;
+    int     max_project_slope;
+} viewtables_t;
+
+static viewtables_t viewtables[2];
+static int live_viewtables;
+
+// Size whose tables are being built in the background.
+static viewsize_t pending_viewsize;
+static background_t *pending_job = NULL;
+
 //
 // CalcMaxProjectSlope
 // [Woof!] Calculate the minimum divider needed to provide at least 45 degrees
 // of FOV padding. For fast rejection during sprite/voxel projection.
 //
 
-static void CalcMaxProjectSlope (int fov)
+static int CalcMaxProjectSlope (int fov)
 {
-    max_project_slope = 16;
-
     for (int i = 1; i < 16; i++)
     {
         if (atan(i) * FINEANGLES / M_PI - fov >= FINEANGLES / 8)
         {
-            max_project_slope = i;
-            break;
+            return i;
         }
     }
+
+    return 16;
 }
 
 // -----------------------------------------------------------------------------
-// R_InitTextureMapping
+// InitTextureMapping
 // [JN] Replaced slow linear search with binary search, merged loops,
 // precomputed values, and tightened variable scopes - boosting speed
 // while keeping identical behavior.
 // -----------------------------------------------------------------------------
 
-void R_InitTextureMapping (void)
+static void InitTextureMapping (const viewsize_t *vs, viewtables_t *t)
 {
     // Calc focallength 
-    const fixed_t focallength = FixedDiv(centerxfrac, fovscale);
+    const fixed_t focallength = FixedDiv(vs->centerxfrac, vs->fovscale);
     
     // Calculate FOV
     angle_t fov;
-    if (vid_fov == 90 && centerxfrac == centerxfrac_nonwide)
+    if (vs->fov == 90 && vs->centerxfrac == vs->centerxfrac_nonwide)
     {
         fov = FIELDOFVIEW;
     }
     else
     {
-        const double slope = (tan(vid_fov * M_PI / 360.0)
-                           * centerxfrac / centerxfrac_nonwide);
+        const double slope = (tan(vs->fov * M_PI / 360.0)
+                           * vs->centerxfrac / vs->centerxfrac_nonwide);
         fov = atan(slope) * FINEANGLES / M_PI;
     }
 
     // First pass: fill viewangletox
-    const int max_x = viewwidth + 1;
+    const int max_x = vs->viewwidth + 1;
     const int min_x = -1;
-    const fixed_t centerxfrac_adj = centerxfrac + FRACUNIT - 1;
+    const fixed_t centerxfrac_adj = vs->centerxfrac + FRACUNIT - 1;
     
     for (int i = 0; i < FINEANGLES/2; i++)
     {
         const fixed_t tangent = finetangent[i];
         
-        if (tangent > fovscale)
+        if (tangent > vs->fovscale)
         {
-            viewangletox[i] = 0;
+            t->viewangletox[i] = 0;
         }
-        else if (tangent < -fovscale)
+        else if (tangent < -vs->fovscale)
         {
-            viewangletox[i] = viewwidth;
+            t->viewangletox[i] = vs->viewwidth;
         }
         else
         {
-            const int t = (centerxfrac_adj - FixedMul(tangent, focallength)) >> FRACBITS;
-            viewangletox[i] = (t < min_x) ? min_x : (t > max_x) ? max_x : t;
+            const int x = (centerxfrac_adj - FixedMul(tangent, focallength)) >> FRACBITS;
+            t->viewangletox[i] = (x < min_x) ? min_x : (x > max_x) ? max_x : x;
         }
     }
 
     // Second pass: build xtoviewangle using binary search
-    const int linear_factor = (((SCREENWIDTH << 6) / viewwidth)
-                            * (ANG90 / (NONWIDEWIDTH << 6))) / fovdiff;
-    const int width_shift = viewwidth / 2;
+    const int linear_factor = (((vs->screenwidth << 6) / vs->viewwidth)
+                            * (ANG90 / (vs->nonwidewidth << 6))) / vs->fovdiff;
+    const int width_shift = vs->viewwidth / 2;
     const int fineangles_half = FINEANGLES / 2;
     
-    for (int x = 0; x <= viewwidth; x++)
+    for (int x = 0; x <= vs->viewwidth; x++)
     {
         int low = 0;
         int high = fineangles_half - 1;
@@ -451,7 +501,7 @@ void R_InitTextureMapping (void)
         while (low <= high)
         {
             const int mid = (low + high) >> 1;
-            if (viewangletox[mid] > x)
+            if (t->viewangletox[mid] > x)
             {
                 low = mid + 1;
             }
@@ -461,15 +511,58 @@ void R_InitTextureMapping (void)
             }
         }
         
-        xtoviewangle[x] = (low << ANGLETOFINESHIFT) - ANG90;
+        t->xtoviewangle[x] = (low << ANGLETOFINESHIFT) - ANG90;
         // [crispy] calculate sky angle for drawing horizontally linear skies.
         // Taken from GZDoom and refactored for integer math.
-        linearskyangle[x] = (width_shift - x) * linear_factor;
+        t->linearskyangle[x] = (width_shift - x) * linear_factor;
     }
     
     // Final adjustments
-    clipangle = xtoviewangle[0];
-    CalcMaxProjectSlope(fov);
+    t->clipangle = t->xtoviewangle[0];
+    t->max_project_slope = CalcMaxProjectSlope(fov);
+}
+
+// -----------------------------------------------------------------------------
+// BuildViewTables
+//  [JN] Build the tables for the given view size. Only reads the view
+//  size and constant tables, so that it can run on another thread.
+// -----------------------------------------------------------------------------
+
+static void BuildViewTables (const viewsize_t *vs, viewtables_t *t)
+{
+    InitTextureMapping(vs, t);
+
+    // planes
+    {
+        // [crispy] re-generate lookup-table for yslope[] (free look)
+        // whenever "dp_detail_level" or "dp_screen_size" change
+        // [JN] FOV from DOOM Retro and Nugget Doom
+        // [PN] Optimized: moved invariant calculations out of loops for better performance
+        const fixed_t half_fracunit = FRACUNIT >> 1;
+        const fixed_t half_viewheight = vs->viewheight >> 1;
+        const fixed_t num = FixedMul(FixedDiv(FRACUNIT, vs->fovscale), (vs->viewwidth << vs->detailshift) * half_fracunit);
+        const fixed_t step = (vs->screen_size < 11 ? vs->screen_size : 11);
+
+        for (int i = 0; i < vs->viewheight; i++)
+        {
+            for (int j = 0; j < LOOKDIRS; j++)
+            {
+                const fixed_t dy = abs((i - (half_viewheight + ((j - LOOKDIRMIN) * vs->resolution) * step / 10)) << FRACBITS) + half_fracunit;
+                t->yslopes[j][i] = FixedDiv(num, dy);
+            }
+        }
+    }
+
+    for (int i = 0 ; i < vs->viewwidth ; i++)
+    {
+	const fixed_t cosadj = abs(finecosine[t->xtoviewangle[i]>>ANGLETOFINESHIFT]);
+	t->distscale[i] = FixedDiv (FRACUNIT,cosadj);
+    }
+}
+
+static void ViewTablesJob (void *unused)
+{
+    BuildViewTables(&pending_viewsize, &viewtables[live_viewtables ^ 1]);
 }
 
 
@@ -568,8 +661,8 @@ void R_InitLightTables (void)
     // [PN] Free after zlight[][] is built
     free(scale_table);
 
-    // [JN] Initialize and generate colored scalelights and zlights. 
-    R_InitColoredLightTables();
+    // [JN] Colored zlights follow these, generate them again when used.
+    R_FreeColoredLights();
 }
 
 //
@@ -610,66 +703,63 @@ R_SetViewSize
 }
 
 
-//
-// R_ExecuteSetViewSize
-//
-void R_ExecuteSetViewSize (void)
+// -----------------------------------------------------------------------------
+// CalcViewSize
+//  [JN] Work out the view size for the current settings.
+// -----------------------------------------------------------------------------
+
+static void CalcViewSize (viewsize_t *vs)
 {
-    fixed_t	cosadj;
-    int		i;
-    int		j;
     double	WIDEFOVDELTA;  // [JN] FOV from DOOM Retro and Nugget Doom
 
-    setsizeneeded = false;
-
     if (setblocks >= 11) // [crispy] Crispy HUD
     {
-	scaledviewwidth_nonwide = NONWIDEWIDTH;
-	scaledviewwidth = SCREENWIDTH;
-	viewheight = SCREENHEIGHT;
+	vs->scaledviewwidth_nonwide = NONWIDEWIDTH;
+	vs->scaledviewwidth = SCREENWIDTH;
+	vs->viewheight = SCREENHEIGHT;
     }
     // [crispy] hard-code to SCREENWIDTH and SCREENHEIGHT minus status bar height
     else if (setblocks == 10)
     {
-	scaledviewwidth_nonwide = NONWIDEWIDTH;
-	scaledviewwidth = SCREENWIDTH;
-	viewheight = SCREENHEIGHT-(ST_HEIGHT*vid_resolution);
+	vs->scaledviewwidth_nonwide = NONWIDEWIDTH;
+	vs->scaledviewwidth = SCREENWIDTH;
+	vs->viewheight = SCREENHEIGHT-(ST_HEIGHT*vid_resolution);
     }
     else
     {
-	scaledviewwidth_nonwide = (setblocks*32)*vid_resolution;
-	viewheight = ((setblocks*168/10)&~7)*vid_resolution;
+	vs->scaledviewwidth_nonwide = (setblocks*32)*vid_resolution;
+	vs->viewheight = ((setblocks*168/10)&~7)*vid_resolution;
 
 	// [crispy] regular viewwidth in non-widescreen mode
 	if (vid_widescreen)
 	{
 		const int widescreen_edge_aligner = 8 * vid_resolution;
 
-		scaledviewwidth = viewheight*SCREENWIDTH/(SCREENHEIGHT-(ST_HEIGHT*vid_resolution));
+		vs->scaledviewwidth = vs->viewheight*SCREENWIDTH/(SCREENHEIGHT-(ST_HEIGHT*vid_resolution));
 		// [crispy] make sure scaledviewwidth is an integer multiple of the bezel patch width
-		scaledviewwidth = (scaledviewwidth / widescreen_edge_aligner) * widescreen_edge_aligner;
-		scaledviewwidth = MIN(scaledviewwidth, SCREENWIDTH);
+		vs->scaledviewwidth = (vs->scaledviewwidth / widescreen_edge_aligner) * widescreen_edge_aligner;
+		vs->scaledviewwidth = MIN(vs->scaledviewwidth, SCREENWIDTH);
 	}
 	else
 	{
-		scaledviewwidth = scaledviewwidth_nonwide;
+		vs->scaledviewwidth = vs->scaledviewwidth_nonwide;
 	}
     }
     
     // [JN] Enforce LOW detail for 1x resolution to represent vanilla render.
     if (vid_resolution == 1)
     {
-        detailshift = 1;
+        vs->detailshift = 1;
     }
     else
     {
-        detailshift = setdetail;
+        vs->detailshift = setdetail;
     }
-    viewwidth = scaledviewwidth>>detailshift;
-    viewwidth_nonwide = scaledviewwidth_nonwide>>detailshift;
+    vs->viewwidth = vs->scaledviewwidth>>vs->detailshift;
+    vs->viewwidth_nonwide = vs->scaledviewwidth_nonwide>>vs->detailshift;
 	
     // [JN] FOV from DOOM Retro and Nugget Doom
-    fovdiff = (float) 90 / vid_fov;
+    vs->fovdiff = (float) 90 / vid_fov;
     if (vid_widescreen) 
     {
         // fov * 0.82 is vertical FOV for 4:3 aspect ratio
@@ -681,13 +771,43 @@ void R_ExecuteSetViewSize (void)
         WIDEFOVDELTA = 0;
     }
 
+    vs->centerxfrac = (vs->viewwidth/2)<<FRACBITS;
+    vs->centerxfrac_nonwide = (vs->viewwidth_nonwide/2)<<FRACBITS;
+    // [JN] FOV from DOOM Retro and Nugget Doom
+    vs->fovscale = finetangent[(int)(FINEANGLES / 4 + (vid_fov + WIDEFOVDELTA) * FINEANGLES / 360 / 2)];
+
+    vs->screenwidth = SCREENWIDTH;
+    vs->screenheight = SCREENHEIGHT;
+    vs->nonwidewidth = NONWIDEWIDTH;
+    vs->resolution = vid_resolution;
+    vs->screen_size = dp_screen_size;
+    vs->fov = vid_fov;
+}
+
+// -----------------------------------------------------------------------------
+// ApplyViewSize
+//  [JN] Switch to a view size, whose tables have been built.
+// -----------------------------------------------------------------------------
+
+static void ApplyViewSize (const viewsize_t *vs, viewtables_t *t)
+{
+    int		i;
+    int		j;
+
+    scaledviewwidth_nonwide = vs->scaledviewwidth_nonwide;
+    scaledviewwidth = vs->scaledviewwidth;
+    viewheight = vs->viewheight;
+    detailshift = vs->detailshift;
+    viewwidth = vs->viewwidth;
+    viewwidth_nonwide = vs->viewwidth_nonwide;
+    fovdiff = vs->fovdiff;
+
     centery = viewheight/2;
     centerx = viewwidth/2;
-    centerxfrac = centerx<<FRACBITS;
+    centerxfrac = vs->centerxfrac;
     centeryfrac = centery<<FRACBITS;
-    centerxfrac_nonwide = (viewwidth_nonwide/2)<<FRACBITS;
-    // [JN] FOV from DOOM Retro and Nugget Doom
-    fovscale = finetangent[(int)(FINEANGLES / 4 + (vid_fov + WIDEFOVDELTA) * FINEANGLES / 360 / 2)];
+    centerxfrac_nonwide = vs->centerxfrac_nonwide;
+    fovscale = vs->fovscale;
     projection = FixedDiv(centerxfrac, fovscale);
 
     if (!detailshift)
@@ -716,8 +836,17 @@ void R_ExecuteSetViewSize (void)
     }
 
     R_InitBuffer (scaledviewwidth, viewheight);
-	
-    R_InitTextureMapping ();
+
+    // [JN] Make the new tables live.
+    live_viewtables = t - viewtables;
+    viewangletox = t->viewangletox;
+    xtoviewangle = t->xtoviewangle;
+    linearskyangle = t->linearskyangle;
+    clipangle = t->clipangle;
+    max_project_slope = t->max_project_slope;
+    yslopes = t->yslopes;
+    yslope = yslopes[LOOKDIRMIN];
+    distscale = t->distscale;
     
     // psprite scales
     pspritescale = FRACUNIT*viewwidth_nonwide/ORIGWIDTH;
@@ -727,34 +856,6 @@ void R_ExecuteSetViewSize (void)
     for (i=0 ; i<viewwidth ; i++)
 	screenheightarray[i] = viewheight;
     
-    // planes
-    {
-        // [crispy] re-generate lookup-table for yslope[] (free look)
-        // whenever "dp_detail_level" or "dp_screen_size" change
-        // [JN] FOV from DOOM Retro and Nugget Doom
-        // [PN] Optimized: moved invariant calculations out of loops for better performance
-        const fixed_t half_fracunit = FRACUNIT >> 1;
-        const fixed_t half_viewheight = viewheight >> 1;
-        const fixed_t num = FixedMul(FixedDiv(FRACUNIT, fovscale), (viewwidth << detailshift) * half_fracunit);
-        const fixed_t step = (dp_screen_size < 11 ? dp_screen_size : 11);
-
-        for (i = 0; i < viewheight; i++)
-        {
-            for (j = 0; j < LOOKDIRS; j++)
-            {
-                const fixed_t dy = abs((i - (half_viewheight + ((j - LOOKDIRMIN) * vid_resolution) * step / 10)) << FRACBITS) + half_fracunit;
-                yslopes[j][i] = FixedDiv(num, dy);
-            }
-        }
-    }
-    yslope = yslopes[LOOKDIRMIN];
-	
-    for (i=0 ; i<viewwidth ; i++)
-    {
-	cosadj = abs(finecosine[xtoviewangle[i]>>ANGLETOFINESHIFT]);
-	distscale[i] = FixedDiv (FRACUNIT,cosadj);
-    }
-    
     // [PN] Precalculate lighting scale table before generating scalelight[][]
     int *scale_table = malloc(MAXLIGHTSCALE * sizeof(*scale_table));
     {
@@ -786,8 +887,8 @@ void R_ExecuteSetViewSize (void)
     // [PN] Free after scalelight[][] is built
     free(scale_table);
 
-    // [JN] (Re-)generate colored scalelight levels.
-    R_GenerateColoredSClights(viewwidth_nonwide);
+    // [JN] Colored scalelights follow these, generate them again when used.
+    R_FreeColoredLights();
 
     // [crispy] lookup table for horizontal screen coordinates
     for (i = 0, j = SCREENWIDTH - 1; i < SCREENWIDTH; i++, j--)
@@ -802,6 +903,82 @@ void R_ExecuteSetViewSize (void)
     st_fullupdate = true; // [JN] Redraw status bar background.
 }
 
+// [JN] Drop the size being built in the background, if any.
+
+static void CancelSetViewSize (void)
+{
+    if (pending_job != NULL)
+    {
+        I_WaitBackground(pending_job);
+        pending_job = NULL;
+    }
+}
+
+//
+// R_ExecuteSetViewSize
+// [JN] Change the view size right away.
+//
+void R_ExecuteSetViewSize (void)
+{
+    viewsize_t vs;
+
+    CancelSetViewSize();
+    setsizeneeded = false;
+
+    CalcViewSize(&vs);
+    BuildViewTables(&vs, &viewtables[live_viewtables ^ 1]);
+    ApplyViewSize(&vs, &viewtables[live_viewtables ^ 1]);
+}
+
+// -----------------------------------------------------------------------------
+// R_QueueSetViewSize
+//  [JN] Start building the tables for the new view size in the
+//  background. setsizeneeded is kept while another size is still
+//  being built, so that it is queued once that one is done.
+// -----------------------------------------------------------------------------
+
+void R_QueueSetViewSize (void)
+{
+    if (pending_job != NULL)
+    {
+        return;
+    }
+
+    setsizeneeded = false;
+
+    CalcViewSize(&pending_viewsize);
+    pending_job = I_StartBackground(ViewTablesJob, NULL);
+}
+
+// -----------------------------------------------------------------------------
+// R_SwapViewSize
+//  [JN] Between frames, switch to the size built in the background once
+//  it's ready. Returns true if the view size has changed.
+// -----------------------------------------------------------------------------
+
+boolean R_SwapViewSize (void)
+{
+    if (pending_job == NULL || !I_BackgroundDone(pending_job))
+    {
+        return false;
+    }
+
+    CancelSetViewSize();
+
+    // The screen may have been reinitialized meanwhile.
+    if (pending_viewsize.screenwidth != SCREENWIDTH
+     || pending_viewsize.screenheight != SCREENHEIGHT
+     || pending_viewsize.resolution != vid_resolution)
+    {
+        setsizeneeded = true;
+        return false;
+    }
+
+    ApplyViewSize(&pending_viewsize, &viewtables[live_viewtables ^ 1]);
+
+    return true;
+}
+
 
 
 //
@@ -919,6 +1096,7 @@ void R_SetupFrame (player_t* player)
             viewx = LerpFixed(player->mo->oldx, player->mo->x);
             viewy = LerpFixed(player->mo->oldy, player->mo->y);
             viewz = LerpFixed(player->oldviewz, player->viewz);
+            viewmobjz = LerpFixed(player->mo->oldz, player->mo->z);
 
             if (use_localview)
             {
@@ -938,6 +1116,7 @@ void R_SetupFrame (player_t* player)
             viewx = player->mo->x;
             viewy = player->mo->y;
             viewz = player->viewz;
+            viewmobjz = player->mo->z;
             viewangle = player->mo->angle;
 
             // [crispy] pitch is actual lookdir and weapon pitch
@@ -988,6 +1167,9 @@ void R_RenderPlayerView (player_t *player)
     // Start frame
     R_SetupFrame (player);
 
+    // [JN] The view window is redrawn entirely.
+    V_MarkRect(viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+
     // [JN] Fill view buffer with black color to prevent
     // overbrighting from post-processing effects and 
     // forcefully update status bar if any effect is active.
@@ -1002,6 +1184,11 @@ void R_RenderPlayerView (player_t *player)
     R_ClearDrawSegs ();
     R_ClearPlanes ();
     R_ClearSprites ();
+
+    // [JN] Interpolate the moving parts of the world once, before
+    // the BSP walk, rather than for every visited subsector.
+    R_InterpolateSectors();
+
     if (automapactive && !automap_overlay)
     {
         R_RenderBSPNode (numnodes-1);
@@ -87,8 +87,8 @@ static lighttable_t**		planezlight;
 static fixed_t			planeheight;
 
 fixed_t*			yslope;
-fixed_t			yslopes[LOOKDIRS][MAXHEIGHT];
-fixed_t			distscale[MAXWIDTH];
+fixed_t			(*yslopes)[MAXHEIGHT];  // [JN] See R_ExecuteSetViewSize.
+fixed_t			*distscale;
 
 fixed_t			cachedheight[MAXHEIGHT];
 fixed_t			cacheddistance[MAXHEIGHT];
@@ -400,13 +400,97 @@ R_MakeSpans
 
 
 
+#define SKYTEXTUREMIDSHIFTED 200
+
+// -----------------------------------------------------------------------------
+// Sky strips
+//  [JN] Both sky layers are composited through the colormap into a strip
+//  around the whole sky circle, one column per sky angle, so that sky
+//  columns are drawn with a single lookup per pixel. The back layer is
+//  offset by skysmoothdelta, whose fraction carries into the next column
+//  or not depending on the view angle, so there is a strip for either
+//  case. They are built when first used, and again when the layers, the
+//  offset, the colormap or the view height change.
+// -----------------------------------------------------------------------------
+
+#define SKYSTRIPWIDTH (1 << (32 - ANGLETOSKYSHIFT))
+
+typedef struct
+{
+    pixel_t *pixels;
+    size_t   size;
+    boolean  valid;
+    int      texture;
+    int      texture2;
+    angle_t  offset;
+    const lighttable_t *colormap;
+    int      toprow;
+    int      rows;
+} skystrip_t;
+
+static skystrip_t skystrips[2];
+
+void R_FreeSkyStrips (void)
+{
+    for (int i = 0 ; i < 2 ; i++)
+    {
+        free(skystrips[i].pixels);
+        skystrips[i].pixels = NULL;
+        skystrips[i].size = 0;
+        skystrips[i].valid = false;
+    }
+}
+
+static const pixel_t *R_SkyStrip (const int carry, const lighttable_t *colormap,
+                                  const int toprow, const int rows)
+{
+    skystrip_t *const strip = &skystrips[carry];
+    const int texture = texturetranslation[skytexture2];
+    const int texture2 = texturetranslation[skytexture];
+    const angle_t offset = ((angle_t) skysmoothdelta >> ANGLETOSKYSHIFT) + carry;
+
+    if (strip->valid && strip->texture == texture && strip->texture2 == texture2
+     && strip->offset == offset && strip->colormap == colormap
+     && strip->toprow == toprow && strip->rows == rows)
+    {
+        return strip->pixels;
+    }
+
+    if (strip->size < (size_t) SKYSTRIPWIDTH * rows)
+    {
+        strip->size = (size_t) SKYSTRIPWIDTH * rows;
+        strip->pixels = I_Realloc(strip->pixels, strip->size * sizeof(*strip->pixels));
+    }
+
+    // Sky 1 in front, the back layer shows through its transparent pixels.
+    for (int x = 0 ; x < SKYSTRIPWIDTH ; x++)
+    {
+        const byte *const source = R_GetColumn(texture, x) + toprow;
+        const byte *const source2 = R_GetColumn(texture2, (x + offset) & (SKYSTRIPWIDTH - 1)) + toprow;
+        pixel_t *const dest = strip->pixels + (size_t) x * rows;
+
+        for (int y = 0 ; y < rows ; y++)
+        {
+            dest[y] = colormap[source[y] ? source[y] : source2[y]];
+        }
+    }
+
+    strip->valid = true;
+    strip->texture = texture;
+    strip->texture2 = texture2;
+    strip->offset = offset;
+    strip->colormap = colormap;
+    strip->toprow = toprow;
+    strip->rows = rows;
+
+    return strip->pixels;
+}
+
 //
 // R_DrawPlanes
 // At the end of each frame.
 //
 
-#define SKYTEXTUREMIDSHIFTED 200
-
 void R_DrawPlanes (void)
 {
     // [JN] CRL - openings counter.
@@ -425,6 +509,16 @@ void R_DrawPlanes (void)
             // [JN] Jaguar: sky is always colored with invul effect.
             dc_colormap[0] = dc_colormap[1] = invulcolormap ? invulmaps : colormaps;
 
+            // [JN] Sky rows the view can reach at any pitch, see R_SetupFrame.
+            const int fracstep = FRACUNIT / vid_resolution;
+            const int step = dp_screen_size < 11 ? dp_screen_size : 11;
+            const int centery_min = viewheight/2 - LOOKDIRMIN * vid_resolution * step / 10;
+            const int centery_max = viewheight/2 + LOOKDIRMAX * vid_resolution * step / 10;
+            const int toprow = (SKYTEXTUREMIDSHIFTED * FRACUNIT - centery_max * fracstep) >> FRACBITS;
+            const int rows = ((SKYTEXTUREMIDSHIFTED * FRACUNIT + (viewheight - 1 - centery_min) * fracstep) >> FRACBITS) - toprow + 1;
+            const angle_t offset = (angle_t) skysmoothdelta >> ANGLETOSKYSHIFT;
+            const pixel_t *strips[2] = { NULL, NULL };
+
             for (int x = pl->minx ; x <= pl->maxx ; x++)
             {
                 dc_yl = pl->top[x];
@@ -434,7 +528,8 @@ void R_DrawPlanes (void)
                 {
                     // [JN] Render sky as 2 layers, sky 1 in front
                     angle_t angle, angle2;
-                    int frac, fracstep;
+                    int frac, carry;
+                    const pixel_t *column;
                     int count = dc_yh - dc_yl;
 
                     if (count < 0)
@@ -447,9 +542,14 @@ void R_DrawPlanes (void)
                               linearskyangle[x] : xtoviewangle[x])) ^ gp_flip_levels) >> ANGLETOSKYSHIFT;
                     angle2 = ((viewangle + skysmoothdelta + (vis_linear_sky ? 
                                linearskyangle[x] : xtoviewangle[x])) ^ gp_flip_levels) >> ANGLETOSKYSHIFT;
-                    dc_source = R_GetColumn(texturetranslation[skytexture2], angle);
-                    dc_source2 = R_GetColumn(texturetranslation[skytexture], angle2);
-                    fracstep = FRACUNIT / vid_resolution;
+                    carry = (angle2 - angle - offset) & (SKYSTRIPWIDTH - 1);
+
+                    if (strips[carry] == NULL)
+                    {
+                        strips[carry] = R_SkyStrip(carry, dc_colormap[0], toprow, rows);
+                    }
+
+                    column = strips[carry] + (size_t) angle * rows - toprow;
                     frac = SKYTEXTUREMIDSHIFTED * FRACUNIT + (dc_yl - centery) * fracstep;
 
                     // [JN] HIGH detail mode.
@@ -459,19 +559,7 @@ void R_DrawPlanes (void)
 
                         do
                         {
-                            const int fraccalc = frac >> FRACBITS;
-                            const byte source1 = dc_source[fraccalc];
-                            const byte source2 = dc_source2[fraccalc];
-                            
-                            if (dc_source[fraccalc])
-                            {
-                                *dest = dc_colormap[dc_brightmap[source1]][source1];
-                            }
-                            else
-                            {
-                                *dest = dc_colormap[dc_brightmap[source2]][source2];
-                            }
-
+                            *dest = column[frac >> FRACBITS];
                             dest += SCREENWIDTH;
                             frac += fracstep;
                         } while (count--);
@@ -485,19 +573,7 @@ void R_DrawPlanes (void)
 
                         do
                         {
-                            const int fraccalc = frac >> FRACBITS;
-                            const byte source1 = dc_source[fraccalc];
-                            const byte source2 = dc_source2[fraccalc];
-                            
-                            if (dc_source[fraccalc])
-                            {
-                                *dest1 = *dest2 = dc_colormap[dc_brightmap[source1]][source1];
-                            }
-                            else
-                            {
-                                *dest1 = *dest2 = dc_colormap[dc_brightmap[source2]][source2];
-                            }
-
+                            *dest1 = *dest2 = column[frac >> FRACBITS];
                             dest1 += SCREENWIDTH;
                             dest2 += SCREENWIDTH;
                             frac += fracstep;
@@ -107,6 +107,10 @@ static boolean mus_paused;
 
 static musicinfo_t *mus_playing = NULL;
 
+// [JN] Music lump of the song being prefetched, or -1.
+
+static int prefetch_lumpnum = -1;
+
 // [JN] Always allocate 8 SFX channels.
 // No memory reallocation will be needed upon changing of channels number.
 
@@ -412,8 +416,12 @@ static int64_t S_ApproxDistanceZ (int64_t dx, int64_t dy, int64_t dz)
 // Otherwise, modifies parameters and returns 1.
 //
 
-static int S_AdjustSoundParams(mobj_t *listener, mobj_t *source,
-                               int *vol, int *sep)
+// [JN] Listener is given by position and angle, so the interpolated
+// view can be used as well as the listener's mobj.
+
+static int S_AdjustSoundParamsAt(fixed_t lx, fixed_t ly, fixed_t lz,
+                                 angle_t langle, mobj_t *source,
+                                 int *vol, int *sep)
 {
     int64_t        approx_dist;
     int64_t        adx;
@@ -423,9 +431,9 @@ static int S_AdjustSoundParams(mobj_t *listener, mobj_t *source,
 
     // calculate the distance to sound origin
     //  and clip it if necessary
-    adx = llabs((int64_t)listener->x - (int64_t)source->x);
-    ady = llabs((int64_t)listener->y - (int64_t)source->y);
-    adz = llabs((int64_t)listener->z - (int64_t)source->z);
+    adx = llabs((int64_t)lx - (int64_t)source->x);
+    ady = llabs((int64_t)ly - (int64_t)source->y);
+    adz = llabs((int64_t)lz - (int64_t)source->z);
 
     // [JN] Always use XYZ sound attenuation.
     approx_dist = S_ApproxDistanceZ(adx, ady, adz);
@@ -436,18 +444,18 @@ static int S_AdjustSoundParams(mobj_t *listener, mobj_t *source,
     }
 
     // angle of source to listener
-    angle = R_PointToAngle2(listener->x,
-                            listener->y,
+    angle = R_PointToAngle2(lx,
+                            ly,
                             source->x,
                             source->y);
 
-    if (angle > listener->angle)
+    if (angle > langle)
     {
-        angle = angle - listener->angle;
+        angle = angle - langle;
     }
     else
     {
-        angle = angle + (0xffffffff - listener->angle);
+        angle = angle + (0xffffffff - langle);
     }
 
     angle >>= ANGLETOFINESHIFT;
@@ -471,6 +479,13 @@ static int S_AdjustSoundParams(mobj_t *listener, mobj_t *source,
     return (*vol > 0);
 }
 
+static int S_AdjustSoundParams(mobj_t *listener, mobj_t *source,
+                               int *vol, int *sep)
+{
+    return S_AdjustSoundParamsAt(listener->x, listener->y, listener->z,
+                                 listener->angle, source, vol, sep);
+}
+
 void S_StartSound(void *origin_p, int sfx_id)
 {
     sfxinfo_t *sfx;
@@ -680,6 +695,62 @@ void S_UpdateSounds(mobj_t *listener)
     }
 }
 
+// -----------------------------------------------------------------------------
+// S_UpdateSoundsFrame
+// [JN] Recalculates volume and stereo separation of playing sounds from
+// the interpolated view position and angle, set up by R_SetupFrame.
+// Called every rendered frame while uncapped framerate is on, so panning
+// follows the camera instead of stepping at 35 Hz. Channels are still
+// allocated and freed only by S_UpdateSounds every game tic.
+// -----------------------------------------------------------------------------
+
+void S_UpdateSoundsFrame (mobj_t *listener)
+{
+    int volume;
+    int sep;
+
+    // Spectator camera is not a listener, view is not set outside of levels.
+    if (!vid_uncapped_fps || crl_spectating || gamestate != GS_LEVEL
+    ||  listener == NULL || !gametic)
+    {
+        return;
+    }
+
+    for (int cnum = 0 ; cnum < snd_channels ; cnum++)
+    {
+        const channel_t *c = &channels[cnum];
+        const sfxinfo_t *sfx = c->sfxinfo;
+
+        if (sfx == NULL || c->origin == NULL || c->origin == listener
+        ||  c->origin == players[displayplayer].so)
+        {
+            continue;
+        }
+
+        volume = snd_SfxVolume;
+
+        if (sfx->link)
+        {
+            volume += sfx->volume;
+            if (volume < 1)
+            {
+                continue;
+            }
+            else if (volume > snd_SfxVolume)
+            {
+                volume = snd_SfxVolume;
+            }
+        }
+
+        // Inaudible sounds are stopped on the next game tic.
+        if (S_AdjustSoundParamsAt(viewx, viewy, viewmobjz, viewangle,
+                                  c->origin, &volume, &sep))
+        {
+            I_UpdateSoundParams(c->handle, volume, sep);
+        }
+    }
+}
+
 void S_SetMusicVolume(int volume)
 {
     if (volume < 0 || volume > 127)
@@ -792,6 +863,12 @@ void S_ChangeMusic(int musicnum, int looping)
 
     music->data = W_CacheLumpNum(music->lumpnum, PU_STATIC);
 
+    // [JN] A prefetched song is picked up by I_RegisterSong.
+    if (music->lumpnum == prefetch_lumpnum)
+    {
+        prefetch_lumpnum = -1;
+    }
+
     handle = I_RegisterSong(music->data, W_LumpLength(music->lumpnum));
     music->handle = handle;
     I_PlaySong(handle, looping);
@@ -799,6 +876,57 @@ void S_ChangeMusic(int musicnum, int looping)
     mus_playing = music;
 }
 
+// -----------------------------------------------------------------------------
+// S_PrefetchLevelMusic
+// [JN] Starts loading the music of the given map in the background, so
+//      that S_Start does not have to do it in the middle of level loading.
+// -----------------------------------------------------------------------------
+
+void S_PrefetchLevelMusic(int map)
+{
+    char namebuf[9];
+    int musicnum;
+    int lumpnum;
+
+    if (emu_jaguar_music)
+    {
+        return;
+    }
+
+    musicnum = idmusnum != -1 ? idmusnum : mus_map01 + map - 1;
+
+    if (musicnum <= mus_None || musicnum >= NUMMUSIC)
+    {
+        return;
+    }
+
+    M_snprintf(namebuf, sizeof(namebuf), "m_%s", S_music[musicnum].name);
+    lumpnum = W_CheckNumForName(namebuf);
+
+    if (lumpnum == prefetch_lumpnum
+     || (mus_playing != NULL && lumpnum == mus_playing->lumpnum))
+    {
+        return;
+    }
+
+    I_CancelPrefetchSong();
+
+    if (prefetch_lumpnum != -1)
+    {
+        W_ReleaseLumpNum(prefetch_lumpnum);
+        prefetch_lumpnum = -1;
+    }
+
+    if (lumpnum < 0)
+    {
+        return;
+    }
+
+    prefetch_lumpnum = lumpnum;
+    I_PrefetchSong(W_CacheLumpNum(lumpnum, PU_STATIC),
+                   W_LumpLength(lumpnum));
+}
+
 boolean S_MusicPlaying(void)
 {
     return I_MusicIsPlaying();
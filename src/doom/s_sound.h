@@ -64,6 +64,9 @@ void S_UnlinkSound(mobj_t *origin);
 //  and set whether looping
 void S_ChangeMusic(int music_id, int looping);
 
+// [JN] Load the music of the given map in the background.
+void S_PrefetchLevelMusic(int map);
+
 // query if music is playing
 boolean S_MusicPlaying(void);
 
@@ -79,6 +82,7 @@ void S_ResumeSound(void);
 // Updates music & sounds
 //
 void S_UpdateSounds(mobj_t *listener);
+void S_UpdateSoundsFrame(mobj_t *listener);
 
 void S_SetMusicVolume(int volume);
 void S_SetSfxVolume(int volume);
@@ -98,6 +98,10 @@
 // graphics are drawn to a backing screen and blitted to the real screen
 static pixel_t *st_backing_screen;
 
+// [JN] Lumps of the bezel pattern around the status bar.
+static lumphandle_t lump_floor7_1 = LUMPHANDLE("FLOOR7_1");
+static lumphandle_t lump_brdr_b = LUMPHANDLE("brdr_b");
+
 // main player in game
 static player_t *plyr; 
 
@@ -1196,9 +1200,8 @@ void ST_Drawer (boolean force)
         {
             byte *src;
             pixel_t *dest;
-            const char *name = "FLOOR7_1";
 
-            src = W_CacheLumpName(name, PU_CACHE);
+            src = W_CacheLumpHandle(&lump_floor7_1, PU_CACHE);
             dest = st_backing_screen;
 
             // [crispy] use unified flat filling function
@@ -1208,7 +1211,7 @@ void ST_Drawer (boolean force)
             if (scaledviewwidth == SCREENWIDTH)
             {
                 int x;
-                patch_t *patch = W_CacheLumpName("brdr_b", PU_CACHE);
+                patch_t *patch = W_CacheLumpHandle(&lump_brdr_b, PU_CACHE);
 
                 for (x = 0 ; x < WIDESCREENDELTA ; x += 8)
                 {
@@ -24,6 +24,7 @@
 #include "s_sound.h"
 #include "v_trans.h"
 #include "v_video.h"
+#include "w_wad.h"
 #include "wi_stuff.h"
 #include "z_zone.h"
 
@@ -65,6 +66,9 @@ static patch_t *colon;		// ":" graphics
 static patch_t *percent;	// percent sign
 static patch_t *num[10];	// 0-9 digits
 
+// [JN] Background, drawn every frame.
+static lumphandle_t lump_title = LUMPHANDLE("M_TITLE");
+
 
 // -----------------------------------------------------------------------------
 // WI_drawNum
@@ -303,7 +307,7 @@ static void WI_drawStats (void)
 	// [crispy] draw total time after level time and par time
 	const int cnt_ttime = wbs->totaltimes / TICRATE;
 
-	V_DrawPatchFullScreen(W_CacheLumpName("M_TITLE", PU_CACHE), false);
+	V_DrawPatchFullScreen(W_CacheLumpHandle(&lump_title, PU_CACHE), false);
 
     // Finished level stuff
     if (wbs->last < NUMMAPS)
@@ -401,6 +405,11 @@ void WI_Ticker (void)
 	{
 		// intermission music
 		S_ChangeMusic(mus_inter, true); 
+
+		// [JN] Load the next level's music and map data
+		// while the stats are shown.
+		S_PrefetchLevelMusic(wbs->next + 1);
+		P_PrefetchLevel(wbs->next + 1);
 	}
 
 	WI_checkForAccelerate();
@@ -0,0 +1,543 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Native sound effects mixer.
+//
+//      All sound effect voices are mixed in a single float pass,
+//      registered as an SDL_mixer post-mix effect, so the output
+//      stream (music and OPL) is already in the buffer and gets
+//      clipped only once. The game thread talks to the audio thread
+//      through a single-producer, single-consumer command queue.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "SDL_mixer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIXER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIXER_NEON
+#endif
+
+#include "i_mixer.h"
+
+
+#ifndef DISABLE_SDL2MIXER
+
+
+// Number of sample frames processed per float pass. Volume and panning
+// changes are ramped across one block, which is ~5ms at 48 kHz.
+#define MIXER_BLOCK 256
+
+// Size of the command queue, must be a power of two.
+#define MIXER_QUEUE_SIZE 512
+
+typedef enum
+{
+    MIXCMD_PLAY,
+    MIXCMD_PARAMS,
+    MIXCMD_STOP,
+} mixcmd_type_t;
+
+typedef struct
+{
+    mixcmd_type_t type;
+    int voice;
+    const Sint16 *data;
+    int frames;
+    float left, right;
+    unsigned int gen;
+} mixcmd_t;
+
+typedef struct
+{
+    const Sint16 *data;
+    int frames;
+    int pos;
+
+    // Current and target per-channel gain, ramped per sample.
+    float gain_l, gain_r;
+    float target_l, target_r;
+
+    unsigned int gen;
+} voice_t;
+
+static boolean mixer_active = false;
+
+// Command queue. Head is only written by the game thread,
+// tail is only written by the audio thread.
+
+static mixcmd_t cmd_queue[MIXER_QUEUE_SIZE];
+static SDL_atomic_t cmd_head;
+static SDL_atomic_t cmd_tail;
+static unsigned int cmd_seq;
+
+// Voice state owned by the audio thread.
+
+static voice_t voices[MIXER_MAX_VOICES];
+static float accum[MIXER_BLOCK * 2];
+
+// Every sound started on a voice gets a new generation number.
+// The audio thread publishes the generation of the last sound that
+// finished on each voice, so the game thread can poll for completion.
+
+static unsigned int voice_gen[MIXER_MAX_VOICES];
+static boolean voice_stopped[MIXER_MAX_VOICES];
+static SDL_atomic_t voice_done[MIXER_MAX_VOICES];
+
+// -----------------------------------------------------------------------------
+// Game thread side
+// -----------------------------------------------------------------------------
+
+static void PushCommand(const mixcmd_t *cmd)
+{
+    // The audio thread drains the whole queue on every callback, so it
+    // only fills up if the device stalls. Wait for it to catch up.
+
+    while (cmd_seq - (unsigned int) SDL_AtomicGet(&cmd_tail) >= MIXER_QUEUE_SIZE)
+    {
+        SDL_Delay(1);
+    }
+
+    cmd_queue[cmd_seq & (MIXER_QUEUE_SIZE - 1)] = *cmd;
+    ++cmd_seq;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&cmd_head, (int) cmd_seq);
+}
+
+void I_NativeMixerPlay(int voice, const void *data, int frames,
+                       int left, int right)
+{
+    mixcmd_t cmd;
+
+    if (!mixer_active || voice < 0 || voice >= MIXER_MAX_VOICES)
+    {
+        return;
+    }
+
+    ++voice_gen[voice];
+    voice_stopped[voice] = false;
+
+    cmd.type = MIXCMD_PLAY;
+    cmd.voice = voice;
+    cmd.data = data;
+    cmd.frames = frames;
+    cmd.left = left / 255.0f;
+    cmd.right = right / 255.0f;
+    cmd.gen = voice_gen[voice];
+
+    PushCommand(&cmd);
+}
+
+void I_NativeMixerSetParams(int voice, int left, int right)
+{
+    mixcmd_t cmd;
+
+    if (!mixer_active || voice < 0 || voice >= MIXER_MAX_VOICES)
+    {
+        return;
+    }
+
+    cmd.type = MIXCMD_PARAMS;
+    cmd.voice = voice;
+    cmd.data = NULL;
+    cmd.frames = 0;
+    cmd.left = left / 255.0f;
+    cmd.right = right / 255.0f;
+    cmd.gen = voice_gen[voice];
+
+    PushCommand(&cmd);
+}
+
+void I_NativeMixerStop(int voice)
+{
+    mixcmd_t cmd;
+
+    if (!mixer_active || voice < 0 || voice >= MIXER_MAX_VOICES)
+    {
+        return;
+    }
+
+    voice_stopped[voice] = true;
+
+    cmd.type = MIXCMD_STOP;
+    cmd.voice = voice;
+    cmd.data = NULL;
+    cmd.frames = 0;
+    cmd.left = cmd.right = 0.0f;
+    cmd.gen = voice_gen[voice];
+
+    PushCommand(&cmd);
+}
+
+boolean I_NativeMixerIsPlaying(int voice)
+{
+    if (!mixer_active || voice < 0 || voice >= MIXER_MAX_VOICES
+     || voice_stopped[voice])
+    {
+        return false;
+    }
+
+    return (unsigned int) SDL_AtomicGet(&voice_done[voice]) != voice_gen[voice];
+}
+
+unsigned int I_NativeMixerSeq(void)
+{
+    return cmd_seq;
+}
+
+boolean I_NativeMixerSeqDone(unsigned int seq)
+{
+    if (!mixer_active)
+    {
+        return true;
+    }
+
+    return (int) ((unsigned int) SDL_AtomicGet(&cmd_tail) - seq) >= 0;
+}
+
+// -----------------------------------------------------------------------------
+// Audio thread side
+// -----------------------------------------------------------------------------
+
+static void FinishVoice(voice_t *v, int voice)
+{
+    v->data = NULL;
+    SDL_AtomicSet(&voice_done[voice], (int) v->gen);
+}
+
+static void ProcessCommands(void)
+{
+    unsigned int head, tail;
+
+    head = (unsigned int) SDL_AtomicGet(&cmd_head);
+    SDL_MemoryBarrierAcquire();
+    tail = (unsigned int) SDL_AtomicGet(&cmd_tail);
+
+    for ( ; tail != head; ++tail)
+    {
+        const mixcmd_t *cmd = &cmd_queue[tail & (MIXER_QUEUE_SIZE - 1)];
+        voice_t *v = &voices[cmd->voice];
+
+        switch (cmd->type)
+        {
+            case MIXCMD_PLAY:
+                if (v->data != NULL)
+                {
+                    FinishVoice(v, cmd->voice);
+                }
+                v->data = cmd->data;
+                v->frames = cmd->frames;
+                v->pos = 0;
+                v->gain_l = v->target_l = cmd->left;
+                v->gain_r = v->target_r = cmd->right;
+                v->gen = cmd->gen;
+                break;
+
+            case MIXCMD_PARAMS:
+                if (v->gen == cmd->gen)
+                {
+                    v->target_l = cmd->left;
+                    v->target_r = cmd->right;
+                }
+                break;
+
+            case MIXCMD_STOP:
+                if (v->data != NULL && v->gen == cmd->gen)
+                {
+                    FinishVoice(v, cmd->voice);
+                }
+                break;
+        }
+    }
+
+    // Sample data referenced by consumed stop commands
+    // may be freed by the game thread from now on.
+
+    SDL_AtomicSet(&cmd_tail, (int) head);
+}
+
+// Convert a block of the output stream to floats.
+
+static void LoadBlock(const Sint16 *src, int frames)
+{
+    const int count = frames * 2;
+    int i = 0;
+
+#if defined(MIXER_SSE2)
+    for ( ; i + 8 <= count; i += 8)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+        _mm_storeu_ps(accum + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps(accum + i + 4, _mm_cvtepi32_ps(hi));
+    }
+#elif defined(MIXER_NEON)
+    for ( ; i + 8 <= count; i += 8)
+    {
+        const int16x8_t s = vld1q_s16(src + i);
+
+        vst1q_f32(accum + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))));
+        vst1q_f32(accum + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))));
+    }
+#endif
+
+    for ( ; i < count; ++i)
+    {
+        accum[i] = src[i];
+    }
+}
+
+// Convert the mixed block back to 16-bit integers, with saturation.
+
+static void StoreBlock(Sint16 *dest, int frames)
+{
+    const int count = frames * 2;
+    int i = 0;
+
+#if defined(MIXER_SSE2)
+    for ( ; i + 8 <= count; i += 8)
+    {
+        const __m128i lo = _mm_cvtps_epi32(_mm_loadu_ps(accum + i));
+        const __m128i hi = _mm_cvtps_epi32(_mm_loadu_ps(accum + i + 4));
+
+        _mm_storeu_si128((__m128i *) (dest + i), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(MIXER_NEON)
+    for ( ; i + 8 <= count; i += 8)
+    {
+        const int32x4_t lo = vcvtq_s32_f32(vld1q_f32(accum + i));
+        const int32x4_t hi = vcvtq_s32_f32(vld1q_f32(accum + i + 4));
+
+        vst1q_s16(dest + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+
+    for ( ; i < count; ++i)
+    {
+        const float s = accum[i];
+
+        dest[i] = s > 32767.0f ? 32767 : s < -32768.0f ? -32768 : (Sint16) s;
+    }
+}
+
+// Add "frames" frames of a voice to the accumulator, ramping the
+// gain from (gl, gr) by (dl, dr) per frame.
+
+static void MixSamples(const Sint16 *src, int frames,
+                       float gl, float gr, float dl, float dr)
+{
+    int i = 0;
+
+#if defined(MIXER_SSE2)
+    {
+        __m128 gain = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+        const __m128 step = _mm_setr_ps(dl * 2, dr * 2, dl * 2, dr * 2);
+
+        for ( ; i + 2 <= frames; i += 2)
+        {
+            const __m128i s = _mm_loadl_epi64((const __m128i *) (src + i * 2));
+            const __m128 f = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+            const __m128 a = _mm_loadu_ps(accum + i * 2);
+
+            _mm_storeu_ps(accum + i * 2, _mm_add_ps(a, _mm_mul_ps(f, gain)));
+            gain = _mm_add_ps(gain, step);
+        }
+    }
+#elif defined(MIXER_NEON)
+    {
+        const float g[4] = { gl, gr, gl + dl, gr + dr };
+        const float d[4] = { dl * 2, dr * 2, dl * 2, dr * 2 };
+        float32x4_t gain = vld1q_f32(g);
+        const float32x4_t step = vld1q_f32(d);
+
+        for ( ; i + 2 <= frames; i += 2)
+        {
+            const float32x4_t f = vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i * 2)));
+            const float32x4_t a = vld1q_f32(accum + i * 2);
+
+            vst1q_f32(accum + i * 2, vmlaq_f32(a, f, gain));
+            gain = vaddq_f32(gain, step);
+        }
+    }
+#endif
+
+    gl += dl * i;
+    gr += dr * i;
+
+    for ( ; i < frames; ++i)
+    {
+        accum[i * 2] += src[i * 2] * gl;
+        accum[i * 2 + 1] += src[i * 2 + 1] * gr;
+        gl += dl;
+        gr += dr;
+    }
+}
+
+static void MixVoice(voice_t *v, int voice, int frames)
+{
+    const float dl = (v->target_l - v->gain_l) / frames;
+    const float dr = (v->target_r - v->gain_r) / frames;
+    int count = v->frames - v->pos;
+
+    if (count > frames)
+    {
+        count = frames;
+    }
+
+    MixSamples(v->data + v->pos * 2, count, v->gain_l, v->gain_r, dl, dr);
+
+    // The ramp spans the whole block, even if the sound ended early.
+
+    v->gain_l = v->target_l;
+    v->gain_r = v->target_r;
+    v->pos += count;
+
+    if (v->pos >= v->frames)
+    {
+        FinishVoice(v, voice);
+    }
+}
+
+static void NativeMixer_Callback(int chan, void *stream, int len, void *udata)
+{
+    Sint16 *out = (Sint16 *) stream;
+    int frames = len / 4;
+    int i;
+
+    ProcessCommands();
+
+    while (frames > 0)
+    {
+        const int n = frames < MIXER_BLOCK ? frames : MIXER_BLOCK;
+        boolean active = false;
+
+        for (i = 0; i < MIXER_MAX_VOICES; ++i)
+        {
+            if (voices[i].data != NULL)
+            {
+                if (!active)
+                {
+                    LoadBlock(out, n);
+                    active = true;
+                }
+                MixVoice(&voices[i], i, n);
+            }
+        }
+
+        if (active)
+        {
+            StoreBlock(out, n);
+        }
+
+        out += n * 2;
+        frames -= n;
+    }
+}
+
+boolean I_InitNativeMixer(int format, int channels)
+{
+    int i;
+
+    if (format != AUDIO_S16SYS || channels != 2)
+    {
+        fprintf(stderr, "I_InitNativeMixer: Unsupported output format, "
+                        "falling back to SDL_mixer channels.\n");
+        return false;
+    }
+
+    memset(voices, 0, sizeof(voices));
+    memset(voice_gen, 0, sizeof(voice_gen));
+
+    for (i = 0; i < MIXER_MAX_VOICES; ++i)
+    {
+        voice_stopped[i] = true;
+        SDL_AtomicSet(&voice_done[i], 0);
+    }
+
+    cmd_seq = 0;
+    SDL_AtomicSet(&cmd_head, 0);
+    SDL_AtomicSet(&cmd_tail, 0);
+
+    if (!Mix_RegisterEffect(MIX_CHANNEL_POST, NativeMixer_Callback, NULL, NULL))
+    {
+        fprintf(stderr, "I_InitNativeMixer: %s\n", Mix_GetError());
+        return false;
+    }
+
+    mixer_active = true;
+
+    return true;
+}
+
+void I_ShutdownNativeMixer(void)
+{
+    if (!mixer_active)
+    {
+        return;
+    }
+
+    Mix_UnregisterEffect(MIX_CHANNEL_POST, NativeMixer_Callback);
+
+    mixer_active = false;
+}
+
+#else // DISABLE_SDL2MIXER
+
+boolean I_InitNativeMixer(int format, int channels)
+{
+    return false;
+}
+
+void I_ShutdownNativeMixer(void)
+{
+}
+
+void I_NativeMixerPlay(int voice, const void *data, int frames,
+                       int left, int right)
+{
+}
+
+void I_NativeMixerSetParams(int voice, int left, int right)
+{
+}
+
+void I_NativeMixerStop(int voice)
+{
+}
+
+boolean I_NativeMixerIsPlaying(int voice)
+{
+    return false;
+}
+
+unsigned int I_NativeMixerSeq(void)
+{
+    return 0;
+}
+
+boolean I_NativeMixerSeqDone(unsigned int seq)
+{
+    return true;
+}
+
+#endif // DISABLE_SDL2MIXER
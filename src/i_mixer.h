@@ -0,0 +1,47 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Native sound effects mixer.
+//
+
+
+#ifndef __I_MIXER__
+#define __I_MIXER__
+
+#include "doomtype.h"
+
+// Maximum number of voices the native mixer can play at once.
+#define MIXER_MAX_VOICES 64
+
+// Hook the mixer into the SDL_mixer post-mix stage.
+// Returns false if the output format is not supported.
+boolean I_InitNativeMixer(int format, int channels);
+void I_ShutdownNativeMixer(void);
+
+// Commands sent from the game thread to the audio thread.
+// "data" is interleaved 16-bit stereo, "frames" is its length in
+// sample frames, "left" and "right" are 0..255 panning volumes.
+void I_NativeMixerPlay(int voice, const void *data, int frames,
+                       int left, int right);
+void I_NativeMixerSetParams(int voice, int left, int right);
+void I_NativeMixerStop(int voice);
+boolean I_NativeMixerIsPlaying(int voice);
+
+// Sequence number of the last queued command, and a check whether the
+// audio thread has consumed every command up to a given sequence number.
+// Sample data must not be freed until its stop command has been consumed.
+unsigned int I_NativeMixerSeq(void);
+boolean I_NativeMixerSeqDone(unsigned int seq);
+
+#endif
@@ -22,9 +22,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "memio.h"
-#include "mus2mid.h"
-
 #include "i_sound.h"
 #include "i_swap.h"
 #include "m_misc.h"
@@ -44,6 +41,17 @@
 #define GENMIDI_FLAG_FIXED      0x0001         /* fixed pitch */
 #define GENMIDI_FLAG_2VOICE     0x0004         /* double voice (OPL3) */
 
+// [JN] MUS format constants.
+
+#define MUS_HEADER_LENGTH       16
+#define MUS_NUM_CHANNELS        16
+#define MUS_PERCUSSION_CHAN     15
+#define MIDI_PERCUSSION_CHAN    9
+
+// MUS music runs at 140 Hz: 70 ticks per beat at the default 120 bpm.
+
+#define MUS_TICKS_PER_BEAT      70
+
 #define PERCUSSION_LOG_LEN 16
 
 typedef PACKED_STRUCT (
@@ -104,8 +112,34 @@ typedef struct
     // Track iterator used to read new events.
 
     midi_track_iter_t *iter;
+
+    // [JN] MUS data played directly from the lump, used instead of
+    // the iterator for MUS music (iter is NULL then).
+
+    const byte *mus_data;
+    unsigned int mus_len;
+    unsigned int mus_start;
+    unsigned int mus_pos;
+
+    // MIDI channel allocated for each MUS channel, and the last
+    // key velocity used on it.
+
+    int mus_channel_map[MUS_NUM_CHANNELS];
+    byte mus_velocity[MUS_NUM_CHANNELS];
 } opl_track_data_t;
 
+// [JN] Registered song: either a loaded MIDI file, or a MUS lump
+// that is read in place.
+
+typedef struct
+{
+    midi_file_t *midi;
+
+    const byte *mus_data;
+    unsigned int mus_len;
+    unsigned int mus_start;
+} opl_song_t;
+
 typedef struct opl_voice_s opl_voice_t;
 
 struct opl_voice_s
@@ -1365,6 +1399,7 @@ static void ProcessEvent(opl_track_data_t *track, midi_event_t *event)
 
 static void ScheduleTrack(opl_track_data_t *track);
 static void InitChannel(opl_channel_data_t *channel);
+static void StartMusTrack(opl_track_data_t *track);
 
 // Restart a song from the beginning.
 
@@ -1378,6 +1413,12 @@ static void RestartSong(void *unused)
 
     for (i = 0; i < num_tracks; ++i)
     {
+        if (tracks[i].iter == NULL)
+        {
+            StartMusTrack(&tracks[i]);
+            continue;
+        }
+
         MIDI_RestartIterator(tracks[i].iter);
         ScheduleTrack(&tracks[i]);
     }
@@ -1388,6 +1429,25 @@ static void RestartSong(void *unused)
     }
 }
 
+// A track has reached its end.
+
+static void EndTrack(void)
+{
+    --running_tracks;
+
+    // When all tracks have finished, restart the song.
+    // Don't restart the song immediately, but wait for 5ms
+    // before triggering a restart.  Otherwise it is possible
+    // to construct an empty MIDI file that causes the game
+    // to lock up in an infinite loop. (5ms should be short
+    // enough not to be noticeable by the listener).
+
+    if (running_tracks <= 0 && song_looping)
+    {
+        OPL_SetCallback(5000, RestartSong, NULL);
+    }
+}
+
 // Callback function invoked when another event needs to be read from
 // a track.
 
@@ -1410,20 +1470,7 @@ static void TrackTimerCallback(void *arg)
     if (event->event_type == MIDI_EVENT_META
      && event->data.meta.type == MIDI_META_END_OF_TRACK)
     {
-        --running_tracks;
-
-        // When all tracks have finished, restart the song.
-        // Don't restart the song immediately, but wait for 5ms
-        // before triggering a restart.  Otherwise it is possible
-        // to construct an empty MIDI file that causes the game
-        // to lock up in an infinite loop. (5ms should be short
-        // enough not to be noticeable by the listener).
-
-        if (running_tracks <= 0 && song_looping)
-        {
-            OPL_SetCallback(5000, RestartSong, NULL);
-        }
-
+        EndTrack();
         return;
     }
 
@@ -1479,10 +1526,257 @@ static void StartTrack(midi_file_t *file, unsigned int track_num)
     ScheduleTrack(track);
 }
 
+// [JN] MUS playback. Events are decoded straight from the lump into
+// the same MIDI events mus2mid would produce, so that the channel
+// mapping and all the quirks of the MIDI path are kept.
+
+static const byte mus_controller_map[] =
+{
+    MIDI_CONTROLLER_BANK_SELECT_MSB,    // 0 is program change
+    MIDI_CONTROLLER_BANK_SELECT_MSB,
+    MIDI_CONTROLLER_MODULATION,
+    MIDI_CONTROLLER_VOLUME_MSB,
+    MIDI_CONTROLLER_PAN,
+    MIDI_CONTROLLER_EXPRESSION,
+    MIDI_CONTROLLER_REVERB,
+    MIDI_CONTROLLER_CHORUS,
+    MIDI_CONTROLLER_HOLD1_PEDAL,
+    MIDI_CONTROLLER_SOFT_PEDAL,
+    MIDI_CONTROLLER_ALL_SOUND_OFF,
+    MIDI_CONTROLLER_ALL_NOTES_OFF,
+    MIDI_CONTROLLER_POLY_MODE_OFF,
+    MIDI_CONTROLLER_POLY_MODE_ON,
+    MIDI_CONTROLLER_RESET_ALL_CTRLS,
+};
+
+static boolean MusReadByte(opl_track_data_t *track, byte *result)
+{
+    if (track->mus_pos >= track->mus_len)
+    {
+        return false;
+    }
+
+    *result = track->mus_data[track->mus_pos++];
+
+    return true;
+}
+
+// Given a MUS channel number, get the MIDI channel number to use.
+// Channels are allocated in order of first use, skipping the MIDI
+// percussion channel, exactly as mus2mid does.
+
+static unsigned int MusChannel(opl_track_data_t *track,
+                               unsigned int mus_channel)
+{
+    midi_event_t event;
+    int max;
+    int i;
+
+    if (mus_channel == MUS_PERCUSSION_CHAN)
+    {
+        return MIDI_PERCUSSION_CHAN;
+    }
+
+    if (track->mus_channel_map[mus_channel] == -1)
+    {
+        max = -1;
+
+        for (i = 0; i < MUS_NUM_CHANNELS; ++i)
+        {
+            if (track->mus_channel_map[i] > max)
+            {
+                max = track->mus_channel_map[i];
+            }
+        }
+
+        if (++max == MIDI_PERCUSSION_CHAN)
+        {
+            ++max;
+        }
+
+        track->mus_channel_map[mus_channel] = max;
+
+        // First time using the channel, send an "all notes off"
+        // event, as mus2mid does (see "The D_DDTBLU disease").
+
+        event.event_type = MIDI_EVENT_CONTROLLER;
+        event.data.channel.channel = max;
+        event.data.channel.param1 = MIDI_CONTROLLER_ALL_NOTES_OFF;
+        event.data.channel.param2 = 0;
+        ProcessEvent(track, &event);
+    }
+
+    return track->mus_channel_map[mus_channel];
+}
+
+// Read and play the next group of events from a MUS track, and get
+// the number of ticks until the following group. Returns false at
+// the end of the score, or if the data is broken.
+
+static boolean MusPlayEvents(opl_track_data_t *track, unsigned int *delay)
+{
+    midi_event_t event;
+    byte descriptor;
+    byte key;
+    byte value;
+    unsigned int wheel;
+
+    do
+    {
+        if (!MusReadByte(track, &descriptor))
+        {
+            return false;
+        }
+
+        event.data.channel.channel = MusChannel(track, descriptor & 0x0F);
+
+        switch (descriptor & 0x70)
+        {
+            case 0x00: // Release key
+                if (!MusReadByte(track, &key))
+                {
+                    return false;
+                }
+
+                event.event_type = MIDI_EVENT_NOTE_OFF;
+                event.data.channel.param1 = key & 0x7F;
+                event.data.channel.param2 = 0;
+                break;
+
+            case 0x10: // Press key
+                if (!MusReadByte(track, &key))
+                {
+                    return false;
+                }
+
+                if (key & 0x80)
+                {
+                    if (!MusReadByte(track, &value))
+                    {
+                        return false;
+                    }
+
+                    track->mus_velocity[descriptor & 0x0F] = value & 0x7F;
+                }
+
+                event.event_type = MIDI_EVENT_NOTE_ON;
+                event.data.channel.param1 = key & 0x7F;
+                event.data.channel.param2 =
+                    track->mus_velocity[descriptor & 0x0F];
+                break;
+
+            case 0x20: // Pitch wheel
+                if (!MusReadByte(track, &key))
+                {
+                    return false;
+                }
+
+                wheel = key * 64;
+                event.event_type = MIDI_EVENT_PITCH_BEND;
+                event.data.channel.param1 = wheel & 0x7F;
+                event.data.channel.param2 = (wheel >> 7) & 0x7F;
+                break;
+
+            case 0x30: // System event
+                if (!MusReadByte(track, &value) || value < 10 || value > 14)
+                {
+                    return false;
+                }
+
+                event.event_type = MIDI_EVENT_CONTROLLER;
+                event.data.channel.param1 = mus_controller_map[value];
+                event.data.channel.param2 = 0;
+                break;
+
+            case 0x40: // Change controller
+                if (!MusReadByte(track, &key) || !MusReadByte(track, &value))
+                {
+                    return false;
+                }
+
+                if (key == 0)
+                {
+                    event.event_type = MIDI_EVENT_PROGRAM_CHANGE;
+                    event.data.channel.param1 = value & 0x7F;
+                    event.data.channel.param2 = 0;
+                    break;
+                }
+
+                if (key > 9)
+                {
+                    return false;
+                }
+
+                // Out of range controller values are clamped, as in mus2mid.
+
+                event.event_type = MIDI_EVENT_CONTROLLER;
+                event.data.channel.param1 = mus_controller_map[key];
+                event.data.channel.param2 = (value & 0x80) ? 0x7F : value;
+                break;
+
+            default: // Score end, or unknown event
+                return false;
+        }
+
+        ProcessEvent(track, &event);
+    } while ((descriptor & 0x80) == 0);
+
+    // Read the time until the next group of events.
+
+    *delay = 0;
+
+    do
+    {
+        if (!MusReadByte(track, &value))
+        {
+            return false;
+        }
+
+        *delay = *delay * 128 + (value & 0x7F);
+    } while (value & 0x80);
+
+    return true;
+}
+
+static void MusTimerCallback(void *arg)
+{
+    opl_track_data_t *track = arg;
+    unsigned int delay;
+    uint64_t us;
+
+    if (!MusPlayEvents(track, &delay))
+    {
+        EndTrack();
+        return;
+    }
+
+    us = ((uint64_t) delay * us_per_beat) / ticks_per_beat;
+
+    OPL_SetCallback(us, MusTimerCallback, track);
+}
+
+// Start (or restart) a MUS track from the beginning of the score.
+
+static void StartMusTrack(opl_track_data_t *track)
+{
+    int i;
+
+    track->mus_pos = track->mus_start;
+
+    for (i = 0; i < MUS_NUM_CHANNELS; ++i)
+    {
+        track->mus_channel_map[i] = -1;
+        track->mus_velocity[i] = 127;
+    }
+
+    OPL_SetCallback(0, MusTimerCallback, track);
+}
+
 // Start playing a mid
 
 static void I_OPL_PlaySong(void *handle, boolean looping)
 {
+    opl_song_t *song;
     midi_file_t *file;
     unsigned int i;
 
@@ -1491,17 +1785,19 @@ static void I_OPL_PlaySong(void *handle, boolean looping)
         return;
     }
 
-    file = handle;
+    song = handle;
+    file = song->midi;
 
     // Allocate track data.
 
-    tracks = malloc(MIDI_NumTracks(file) * sizeof(opl_track_data_t));
+    num_tracks = file != NULL ? MIDI_NumTracks(file) : 1;
+    tracks = calloc(num_tracks, sizeof(opl_track_data_t));
 
-    num_tracks = MIDI_NumTracks(file);
     running_tracks = num_tracks;
     song_looping = looping;
 
-    ticks_per_beat = MIDI_GetFileTimeDivision(file);
+    ticks_per_beat = file != NULL ? MIDI_GetFileTimeDivision(file)
+                                  : MUS_TICKS_PER_BEAT;
 
     // Default is 120 bpm.
     // TODO: this is wrong
@@ -1510,9 +1806,19 @@ static void I_OPL_PlaySong(void *handle, boolean looping)
 
     start_music_volume = current_music_volume;
 
-    for (i = 0; i < num_tracks; ++i)
+    if (file != NULL)
+    {
+        for (i = 0; i < num_tracks; ++i)
+        {
+            StartTrack(file, i);
+        }
+    }
+    else
     {
-        StartTrack(file, i);
+        tracks[0].mus_data = song->mus_data;
+        tracks[0].mus_len = song->mus_len;
+        tracks[0].mus_start = song->mus_start;
+        StartMusTrack(&tracks[0]);
     }
 
     for (i = 0; i < MIDI_CHANNELS_PER_TRACK; ++i)
@@ -1589,7 +1895,10 @@ static void I_OPL_StopSong(void)
 
     for (i = 0; i < num_tracks; ++i)
     {
-        MIDI_FreeIterator(tracks[i].iter);
+        if (tracks[i].iter != NULL)
+        {
+            MIDI_FreeIterator(tracks[i].iter);
+        }
     }
 
     free(tracks);
@@ -1602,83 +1911,86 @@ static void I_OPL_StopSong(void)
 
 static void I_OPL_UnRegisterSong(void *handle)
 {
+    opl_song_t *song = handle;
+
     if (!music_initialized)
     {
         return;
     }
 
-    if (handle != NULL)
-    {
-        MIDI_FreeFile(handle);
-    }
-}
-
-static boolean ConvertMus(byte *musdata, int len, char *filename)
-{
-    MEMFILE *instream;
-    MEMFILE *outstream;
-    void *outbuf;
-    size_t outbuf_len;
-    int result;
-
-    instream = mem_fopen_read(musdata, len);
-    outstream = mem_fopen_write();
-
-    result = mus2mid(instream, outstream);
-
-    if (result == 0)
+    if (song != NULL)
     {
-        mem_get_buf(outstream, &outbuf, &outbuf_len);
+        if (song->midi != NULL)
+        {
+            MIDI_FreeFile(song->midi);
+        }
 
-        M_WriteFile(filename, outbuf, outbuf_len);
+        free(song);
     }
-
-    mem_fclose(instream);
-    mem_fclose(outstream);
-
-    return result;
 }
 
 static void *I_OPL_RegisterSong(void *data, int len)
 {
+    opl_song_t *song;
     midi_file_t *result;
     char *filename;
+    unsigned int start;
 
     if (!music_initialized)
     {
         return NULL;
     }
 
-    // MUS files begin with "MUS"
-    // Reject anything which doesnt have this signature
-
-    filename = M_TempFile("doom.mid");
+    // [JN] MUS lumps are played straight from the lump data, which
+    // stays cached until the song is unregistered. No conversion to
+    // MIDI and no temporary file are needed.
 
-    // [crispy] remove MID file size limit
-    if (IsMid(data, len) /* && len < MAXMIDLENGTH */)
-    {
-        M_WriteFile(filename, data, len);
-    }
-    else
+    if (IsMus(data, len))
     {
-        // Assume a MUS file and try to convert
+        if (len < MUS_HEADER_LENGTH)
+        {
+            fprintf(stderr, "I_OPL_RegisterSong: Failed to load MUS.\n");
+            return NULL;
+        }
+
+        start = ((const byte *) data)[6] | (((const byte *) data)[7] << 8);
+
+        if (start >= len)
+        {
+            fprintf(stderr, "I_OPL_RegisterSong: Failed to load MUS.\n");
+            return NULL;
+        }
+
+        song = calloc(1, sizeof(*song));
+        song->mus_data = data;
+        song->mus_len = len;
+        song->mus_start = start;
 
-        ConvertMus(data, len, filename);
+        return song;
     }
 
+    filename = M_TempFile("doom.mid");
+
+    // [crispy] remove MID file size limit
+    M_WriteFile(filename, data, len);
+
     result = MIDI_LoadFile(filename);
 
+    // remove file now
+
+    M_remove(filename);
+    free(filename);
+
     if (result == NULL)
     {
         fprintf(stderr, "I_OPL_RegisterSong: Failed to load MID.\n");
+        return NULL;
     }
 
-    // remove file now
-
-    M_remove(filename);
-    free(filename);
+    song = calloc(1, sizeof(*song));
+    song->midi = result;
 
-    return result;
+    return song;
 }
 
 // Is the song playing?
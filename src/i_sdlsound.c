@@ -31,11 +31,15 @@
 #include <samplerate.h>
 #endif
 
+#include "i_mixer.h"
 #include "i_sound.h"
 #include "i_system.h"
 #include "i_swap.h"
+#include "i_thread.h"
 #include "m_argv.h"
+#include "m_config.h"
 #include "m_misc.h"
+#include "w_file.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -71,22 +75,29 @@ struct allocated_sound_s
     Mix_Chunk chunk;
     int use_count;
     int pitch;
+    // [JN] Native mixer command that last released this sound.
+    unsigned int release_seq;
     allocated_sound_t *prev, *next;
 };
 
 static boolean sound_initialized = false;
 
-static allocated_sound_t *channels_playing[NUM_CHANNELS];
+// [JN] Sound effects are mixed by the native mixer instead of
+// SDL_mixer channels, which allows more channels to be used.
+static boolean native_mixer = false;
+static int num_channels = NUM_CHANNELS;
+
+static allocated_sound_t *channels_playing[MIXER_MAX_VOICES];
 
 static int mixer_freq;
 static Uint16 mixer_format;
 static int mixer_channels;
 static boolean use_sfx_prefix;
-static boolean (*ExpandSoundData)(sfxinfo_t *sfxinfo,
-                                  byte *data,
-                                  int samplerate,
-                                  int bits,
-                                  int length) = NULL;
+static allocated_sound_t *(*ExpandSoundData)(sfxinfo_t *sfxinfo,
+                                             byte *data,
+                                             int samplerate,
+                                             int bits,
+                                             int length) = NULL;
 
 // Doubly-linked list of allocated sounds.
 // When a sound is played, it is moved to the head, so that the oldest
@@ -96,6 +107,12 @@ static allocated_sound_t *allocated_sounds_head = NULL;
 static allocated_sound_t *allocated_sounds_tail = NULL;
 static int allocated_sounds_size = 0;
 
+// [JN] Sounds freed while the native mixer may still be reading them.
+// They are kept here until the audio thread has consumed the command
+// that stopped them.
+
+static allocated_sound_t *released_sounds = NULL;
+
 
 // Hook a sound into the linked list at the head.
 
@@ -149,9 +166,40 @@ static void FreeAllocatedSound(allocated_sound_t *snd)
 
     allocated_sounds_size -= snd->chunk.alen;
 
+    if (native_mixer && !I_NativeMixerSeqDone(snd->release_seq))
+    {
+        snd->next = released_sounds;
+        released_sounds = snd;
+        return;
+    }
+
     free(snd);
 }
 
+// [JN] Free released sounds that are no longer referenced by the
+// native mixer. If "force" is set, free everything (the mixer
+// must be shut down already).
+
+static void FreeReleasedSounds(boolean force)
+{
+    allocated_sound_t **prev = &released_sounds;
+
+    while (*prev != NULL)
+    {
+        allocated_sound_t *snd = *prev;
+
+        if (force || I_NativeMixerSeqDone(snd->release_seq))
+        {
+            *prev = snd->next;
+            free(snd);
+        }
+        else
+        {
+            prev = &snd->next;
+        }
+    }
+}
+
 // Search from the tail backwards along the allocated sounds list, find
 // and free a sound that is not in use, to free up memory.  Return true
 // for success.
@@ -203,6 +251,60 @@ static void ReserveCacheSpace(size_t len)
     }
 }
 
+// Fill in the header of a new sound effect.
+
+static void InitSound(allocated_sound_t *snd, sfxinfo_t *sfxinfo,
+                      byte *abuf, size_t len)
+{
+    snd->chunk.abuf = abuf;
+    snd->chunk.alen = len;
+    snd->chunk.allocated = 1;
+    snd->chunk.volume = MIX_MAX_VOLUME;
+    snd->pitch = NORM_PITCH;
+    snd->release_seq = 0;
+
+    snd->sfxinfo = sfxinfo;
+    snd->use_count = 0;
+}
+
+// [JN] Allocate a block for a new sound effect, without linking it into
+// the list of allocated sounds. Safe to call from worker threads.
+
+static allocated_sound_t *CreateSound(sfxinfo_t *sfxinfo, size_t len)
+{
+    allocated_sound_t *snd;
+
+    // Allocate the sound structure and data.  The data will immediately
+    // follow the structure, which acts as a header.
+
+    snd = malloc(sizeof(allocated_sound_t) + len);
+
+    if (snd != NULL)
+    {
+        // Skip past the chunk structure for the audio buffer
+
+        InitSound(snd, sfxinfo, (byte *) (snd + 1), len);
+    }
+
+    return snd;
+}
+
+// [JN] Link a sound created by CreateSound into the list of
+// allocated sounds.
+
+static void LinkSound(allocated_sound_t *snd)
+{
+    // Keep allocated sounds within the cache size.
+
+    ReserveCacheSpace(snd->chunk.alen);
+
+    // Keep track of how much memory all these cached sounds are using...
+
+    allocated_sounds_size += snd->chunk.alen;
+
+    AllocatedSoundLink(snd);
+}
+
 // Allocate a block for a new sound effect.
 
 static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
@@ -213,12 +315,9 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
 
     ReserveCacheSpace(len);
 
-    // Allocate the sound structure and data.  The data will immediately
-    // follow the structure, which acts as a header.
-
     do
     {
-        snd = malloc(sizeof(allocated_sound_t) + len);
+        snd = CreateSound(sfxinfo, len);
 
         // Out of memory?  Try to free an old sound, then loop round
         // and try again.
@@ -230,17 +329,6 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
 
     } while (snd == NULL);
 
-    // Skip past the chunk structure for the audio buffer
-
-    snd->chunk.abuf = (byte *) (snd + 1);
-    snd->chunk.alen = len;
-    snd->chunk.allocated = 1;
-    snd->chunk.volume = MIX_MAX_VOLUME;
-    snd->pitch = NORM_PITCH;
-
-    snd->sfxinfo = sfxinfo;
-    snd->use_count = 0;
-
     // Keep track of how much memory all these cached sounds are using...
 
     allocated_sounds_size += len;
@@ -351,7 +439,14 @@ static void ReleaseSoundOnChannel(int channel)
 {
     allocated_sound_t *snd = channels_playing[channel];
 
-    Mix_HaltChannel(channel);
+    if (native_mixer)
+    {
+        I_NativeMixerStop(channel);
+    }
+    else
+    {
+        Mix_HaltChannel(channel);
+    }
 
     if (snd == NULL)
     {
@@ -359,6 +454,7 @@ static void ReleaseSoundOnChannel(int channel)
     }
 
     channels_playing[channel] = NULL;
+    snd->release_seq = I_NativeMixerSeq();
 
     UnlockAllocatedSound(snd);
 
@@ -403,17 +499,17 @@ static int SRC_ConversionMode(void)
 //   unsigned 8 bits --> signed 16 bits
 //   mono --> stereo
 //   samplerate --> mixer_freq
-// Returns number of clipped samples.
+// Returns the new sound, or NULL on failure.
 // DWF 2008-02-10 with cleanups by Simon Howard.
-int retn;  // [JN] Exernalized, purely to shutup compiler warning.
 
-static boolean ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
-                                   byte *data,
-                                   int samplerate,
-                                   int bits,
-                                   int length)
+static allocated_sound_t *ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
+                                              byte *data,
+                                              int samplerate,
+                                              int bits,
+                                              int length)
 {
     SRC_DATA src_data;
+    int retn;
     float *data_in;
     uint32_t i, abuf_index=0, clipped=0;
 //    uint32_t alen;
@@ -458,16 +554,19 @@ static boolean ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
 
     retn = src_simple(&src_data, SRC_ConversionMode(), 1);
     assert(retn == 0);
+    (void) retn;
 
     // Allocate the new chunk.
 
 //    alen = src_data.output_frames_gen * 4;
 
-    snd = AllocateSound(sfxinfo, src_data.output_frames_gen * 4);
+    snd = CreateSound(sfxinfo, src_data.output_frames_gen * 4);
 
     if (snd == NULL)
     {
-        return false;
+        free(data_in);
+        free(src_data.data_out);
+        return NULL;
     }
 
     chunk = &snd->chunk;
@@ -530,7 +629,7 @@ static boolean ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
                         400.0 * clipped / chunk->alen);
     }
 
-    return true;
+    return snd;
 }
 
 #endif
@@ -615,13 +714,13 @@ static void WriteWAV(char *filename, byte *data,
 #endif
 
 // Generic sound expansion function for any sample rate.
-// Returns number of clipped samples (always 0).
+// Returns the new sound, or NULL on failure.
 
-static boolean ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
-                                   byte *data,
-                                   int samplerate,
-                                   int bits,
-                                   int length)
+static allocated_sound_t *ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
+                                              byte *data,
+                                              int samplerate,
+                                              int bits,
+                                              int length)
 {
     SDL_AudioCVT convertor;
     allocated_sound_t *snd;
@@ -639,11 +738,11 @@ static boolean ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
 
     // Allocate a chunk in which to expand the sound
 
-    snd = AllocateSound(sfxinfo, expanded_length);
+    snd = CreateSound(sfxinfo, expanded_length);
 
     if (snd == NULL)
     {
-        return false;
+        return NULL;
     }
 
     chunk = &snd->chunk;
@@ -738,26 +837,31 @@ static boolean ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
 #endif /* #ifdef LOW_PASS_FILTER */
     }
 
-    return true;
+    return snd;
 }
 
-// Load and convert a sound effect
-// Returns true if successful
+// [JN] Sound lump being loaded and converted.
 
-static boolean CacheSFX(sfxinfo_t *sfxinfo)
+typedef struct
 {
-    int lumpnum;
-    unsigned int lumplen;
+    sfxinfo_t *sfxinfo;
+    byte *samples;
     int samplerate;
     unsigned int bits;
     unsigned int length;
-    byte *data;
+    unsigned int lumplen;
+    uint32_t hash;
+    allocated_sound_t *snd;
+} sfxjob_t;
 
-    // need to load the sound
+// Check the header of a sound lump and find its sample data.
+// Returns true if this is a valid sound.
 
-    lumpnum = sfxinfo->lumpnum;
-    data = W_CacheLumpNum(lumpnum, PU_STATIC);
-    lumplen = W_LumpLength(lumpnum);
+static boolean ParseSFX(byte *data, unsigned int lumplen, sfxjob_t *job)
+{
+    int samplerate;
+    unsigned int bits;
+    unsigned int length;
 
     // [crispy] Check if this is a valid RIFF wav file
     if (lumplen > 44 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVEfmt ", 8) == 0)
@@ -834,29 +938,355 @@ static boolean CacheSFX(sfxinfo_t *sfxinfo)
         return false;
     }
 
-    // Sample rate conversion
+    job->samples = data + 8;
+    job->samplerate = samplerate;
+    job->bits = bits;
+    job->length = length;
+
+    return true;
+}
+
+// [JN] FNV-1a hash of a sound lump, used as the disk cache key.
+
+static uint32_t HashLump(const byte *data, unsigned int len)
+{
+    uint32_t hash = 2166136261u;
+    unsigned int i;
+
+    for (i = 0; i < len; ++i)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+// Load a sound lump and check its header. On success, the lump stays
+// cached until it is released by the caller.
+
+static boolean LoadSFX(sfxinfo_t *sfxinfo, sfxjob_t *job)
+{
+    const int lumpnum = sfxinfo->lumpnum;
+    byte *data;
+
+    data = W_CacheLumpNum(lumpnum, PU_STATIC);
+
+    job->sfxinfo = sfxinfo;
+    job->lumplen = W_LumpLength(lumpnum);
+    job->snd = NULL;
+
+    if (!ParseSFX(data, job->lumplen, job))
+    {
+        W_ReleaseLumpNum(lumpnum);
+        return false;
+    }
+
+    job->hash = HashLump(data, job->lumplen);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// [JN] Disk cache of converted sound effects.
+//
+// Sounds converted to the mixer format are saved to a single file in
+// the config directory, keyed by a hash of their lumps. The file is only
+// valid for the mixer rate and conversion mode it was written with.
+// On later launches it is loaded with W_OpenFile (memory-mapped where
+// available), and cached sounds point straight into it.
+// -----------------------------------------------------------------------------
+
+#define SFX_CACHE_MAGIC "CRYSFXC1"
+#define SFX_CACHE_FILE  "sfxcache.dat"
+#define SFX_CACHE_ALIGN 16
+
+typedef struct
+{
+    char magic[8];
+    uint32_t freq;
+    uint32_t format;
+    int32_t src_mode;
+    float src_scale;
+    uint32_t numentries;
+} sfxcache_header_t;
+
+typedef struct
+{
+    uint32_t hash;
+    uint32_t lumplen;
+    uint32_t offset;
+    uint32_t length;
+} sfxcache_entry_t;
+
+// The cache file stays open for the rest of the session.
+
+static wad_file_t *sfx_cache_file = NULL;
+static byte *sfx_cache_data = NULL;
+static const sfxcache_entry_t *sfx_cache_entries = NULL;
+static unsigned int sfx_cache_numentries = 0;
+
+static void FillCacheHeader(sfxcache_header_t *header, uint32_t numentries)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SFX_CACHE_MAGIC, sizeof(header->magic));
+    header->freq = mixer_freq;
+    header->format = mixer_format | (mixer_channels << 16);
+#ifdef HAVE_LIBSAMPLERATE
+    header->src_mode = use_libsamplerate;
+    header->src_scale = use_libsamplerate ? libsamplerate_scale : 0.0f;
+#endif
+    header->numentries = numentries;
+}
+
+static void CloseSFXCache(void)
+{
+    if (sfx_cache_file == NULL)
+    {
+        return;
+    }
+
+    if (sfx_cache_data != sfx_cache_file->mapped)
+    {
+        free(sfx_cache_data);
+    }
+
+    W_CloseFile(sfx_cache_file);
+
+    sfx_cache_file = NULL;
+    sfx_cache_data = NULL;
+    sfx_cache_entries = NULL;
+    sfx_cache_numentries = 0;
+}
+
+static boolean OpenSFXCache(void)
+{
+    sfxcache_header_t expected;
+    const sfxcache_header_t *header;
+    wad_file_t *file;
+    byte *data;
+    char *path;
+
+    path = M_StringJoin(configdir, SFX_CACHE_FILE, NULL);
+    file = W_OpenFile(path);
+    free(path);
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    data = file->mapped;
+
+    if (data == NULL && file->length >= sizeof(sfxcache_header_t))
+    {
+        data = malloc(file->length);
+
+        if (data != NULL && W_Read(file, 0, data, file->length) != file->length)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    sfx_cache_file = file;
+    sfx_cache_data = data;
 
-    if (!ExpandSoundData(sfxinfo, data + 8, samplerate, bits, length))
+    if (data == NULL || file->length < sizeof(sfxcache_header_t))
     {
+        CloseSFXCache();
         return false;
     }
 
+    header = (const sfxcache_header_t *) data;
+    FillCacheHeader(&expected, header->numentries);
+
+    if (memcmp(header, &expected, sizeof(expected)) != 0
+     || sizeof(*header) + (uint64_t) header->numentries * sizeof(sfxcache_entry_t) > file->length)
+    {
+        CloseSFXCache();
+        return false;
+    }
+
+    sfx_cache_entries = (const sfxcache_entry_t *) (header + 1);
+    sfx_cache_numentries = header->numentries;
+
+    return true;
+}
+
+// Find a converted sound in the cache. Returns an unlinked sound
+// pointing into the cache file, or NULL if it is not there.
+
+static allocated_sound_t *FindCachedSFX(const sfxjob_t *job)
+{
+    allocated_sound_t *snd;
+    unsigned int i;
+
+    for (i = 0; i < sfx_cache_numentries; ++i)
+    {
+        const sfxcache_entry_t *entry = &sfx_cache_entries[i];
+
+        if (entry->hash == job->hash && entry->lumplen == job->lumplen
+         && (uint64_t) entry->offset + entry->length <= sfx_cache_file->length)
+        {
+            snd = malloc(sizeof(allocated_sound_t));
+
+            if (snd != NULL)
+            {
+                InitSound(snd, job->sfxinfo, sfx_cache_data + entry->offset,
+                          entry->length);
+            }
+
+            return snd;
+        }
+    }
+
+    return NULL;
+}
+
+static void WriteSFXCache(const sfxjob_t *jobs, int numjobs)
+{
+    static const byte padding[SFX_CACHE_ALIGN] = {0};
+    sfxcache_header_t header;
+    sfxcache_entry_t *entries;
+    uint32_t offset;
+    int numentries = 0;
+    FILE *fstream;
+    char *path, *temp_path;
+    boolean failed;
+    int i;
+
+    entries = malloc(numjobs * sizeof(*entries));
+
+    if (entries == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < numjobs; ++i)
+    {
+        if (jobs[i].snd != NULL)
+        {
+            entries[numentries].hash = jobs[i].hash;
+            entries[numentries].lumplen = jobs[i].lumplen;
+            entries[numentries].length = jobs[i].snd->chunk.alen;
+            ++numentries;
+        }
+    }
+
+    offset = sizeof(header) + numentries * sizeof(*entries);
+
+    for (i = 0; i < numentries; ++i)
+    {
+        offset = (offset + SFX_CACHE_ALIGN - 1) & ~(SFX_CACHE_ALIGN - 1);
+        entries[i].offset = offset;
+        offset += entries[i].length;
+    }
+
+    // [JN] Write to a temporary file and rename it over the old cache
+    // once complete, so that a crash or a full disk never leaves a
+    // truncated cache behind.
+
+    path = M_StringJoin(configdir, SFX_CACHE_FILE, NULL);
+    temp_path = M_StringJoin(path, ".tmp", NULL);
+    fstream = M_fopen(temp_path, "wb");
+
+    if (fstream == NULL)
+    {
+        fprintf(stderr, "WriteSFXCache: Unable to write %s\n", temp_path);
+        free(entries);
+        free(temp_path);
+        free(path);
+        return;
+    }
+
+    FillCacheHeader(&header, numentries);
+    fwrite(&header, sizeof(header), 1, fstream);
+    fwrite(entries, sizeof(*entries), numentries, fstream);
+    offset = sizeof(header) + numentries * sizeof(*entries);
+
+    for (i = 0, numentries = 0; i < numjobs; ++i)
+    {
+        const sfxcache_entry_t *entry = &entries[numentries];
+
+        if (jobs[i].snd == NULL)
+        {
+            continue;
+        }
+
+        fwrite(padding, 1, entry->offset - offset, fstream);
+        fwrite(jobs[i].snd->chunk.abuf, 1, entry->length, fstream);
+        offset = entry->offset + entry->length;
+        ++numentries;
+    }
+
+    failed = ferror(fstream) != 0;
+
+    if (fclose(fstream) != 0 || failed)
+    {
+        fprintf(stderr, "WriteSFXCache: Unable to write %s\n", temp_path);
+        M_remove(temp_path);
+    }
+    else
+    {
+        M_remove(path);
+        M_rename(temp_path, path);
+    }
+
+    free(entries);
+    free(temp_path);
+    free(path);
+}
+
+// Load and convert a sound effect
+// Returns true if successful
+
+static boolean CacheSFX(sfxinfo_t *sfxinfo)
+{
+    sfxjob_t job;
+    allocated_sound_t *snd = NULL;
+
+    // need to load the sound
+
+    if (!LoadSFX(sfxinfo, &job))
+    {
+        return false;
+    }
+
+    // [JN] Use the converted sound from disk cache if possible,
+    // otherwise do the sample rate conversion.
+
+    if (sfx_cache_file != NULL)
+    {
+        snd = FindCachedSFX(&job);
+    }
+
+    if (snd == NULL)
+    {
+        snd = ExpandSoundData(sfxinfo, job.samples, job.samplerate,
+                              job.bits, job.length);
+    }
+
+    // don't need the original lump any more
+
+    W_ReleaseLumpNum(sfxinfo->lumpnum);
+
+    if (snd == NULL)
+    {
+        return false;
+    }
+
+    LinkSound(snd);
+
 #ifdef DEBUG_DUMP_WAVS
     {
         char filename[16];
-        allocated_sound_t * snd;
 
         M_snprintf(filename, sizeof(filename), "%s.wav",
                    DEH_String(sfxinfo->name));
-        snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH);
         WriteWAV(filename, snd->chunk.abuf, snd->chunk.alen,mixer_freq);
     }
 #endif
 
-    // don't need the original lump any more
-  
-    W_ReleaseLumpNum(lumpnum);
-
     return true;
 }
 
@@ -882,11 +1312,24 @@ static void GetSfxLumpName(sfxinfo_t *sfx, char *buf, size_t buf_len)
     }
 }
 
+// [JN] Sample rate conversion of one sound, run on worker threads.
+
+static void ExpandSFXJob(int i, void *data)
+{
+    sfxjob_t *job = &((sfxjob_t *) data)[i];
+
+    job->snd = ExpandSoundData(job->sfxinfo, job->samples, job->samplerate,
+                               job->bits, job->length);
+}
+
 // Preload all the sound effects - stops nasty ingame freezes
 
 static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 {
     char namebuf[9];
+    sfxjob_t *jobs;
+    int numjobs = 0;
+    boolean cached;
     int i;
     static boolean precached = false;  // [JN] Precache SFX only once.
 
@@ -897,6 +1340,17 @@ static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 
     printf("I_SDL_PrecacheSounds: Precaching all sound effects - [");
 
+    jobs = malloc(num_sounds * sizeof(*jobs));
+
+    if (jobs == NULL)
+    {
+        printf("]\n");
+        return;
+    }
+
+    // [JN] Lumps are loaded on the main thread, the WAD cache
+    // and zone memory are not thread-safe.
+
     for (i=0; i<num_sounds; ++i)
     {
         if ((i % 6) == 0)
@@ -909,12 +1363,51 @@ static void I_SDL_PrecacheSounds(sfxinfo_t *sounds, int num_sounds)
 
         sounds[i].lumpnum = W_CheckNumForName(namebuf);
 
-        if (sounds[i].lumpnum != -1)
+        if (sounds[i].lumpnum != -1 && LoadSFX(&sounds[i], &jobs[numjobs]))
         {
-            CacheSFX(&sounds[i]);
+            ++numjobs;
         }
     }
 
+    // [JN] Take converted sounds from the disk cache. If any of them is
+    // missing or outdated, convert all sounds on the worker threads
+    // and write the cache anew.
+
+    cached = OpenSFXCache();
+
+    for (i = 0; cached && i < numjobs; ++i)
+    {
+        jobs[i].snd = FindCachedSFX(&jobs[i]);
+        cached = jobs[i].snd != NULL;
+    }
+
+    if (!cached)
+    {
+        for (i = 0; i < numjobs; ++i)
+        {
+            free(jobs[i].snd);
+            jobs[i].snd = NULL;
+        }
+
+        CloseSFXCache();
+
+        I_ParallelFor(numjobs, ExpandSFXJob, jobs);
+
+        WriteSFXCache(jobs, numjobs);
+    }
+
+    for (i = 0; i < numjobs; ++i)
+    {
+        W_ReleaseLumpNum(jobs[i].sfxinfo->lumpnum);
+
+        if (jobs[i].snd != NULL)
+        {
+            LinkSound(jobs[i].snd);
+        }
+    }
+
+    free(jobs);
+
     printf("]\n");
     
     precached = true;
@@ -953,24 +1446,36 @@ static int I_SDL_GetSfxLumpNum(sfxinfo_t *sfx)
     return W_CheckNumForName(namebuf);
 }
 
+static void CalculatePanning(int vol, int sep, int *left, int *right)
+{
+    *left = ((254 - sep) * vol) / 127;
+    *right = ((sep) * vol) / 127;
+
+    if (*left < 0) *left = 0;
+    else if (*left > 255) *left = 255;
+    if (*right < 0) *right = 0;
+    else if (*right > 255) *right = 255;
+}
+
 static void I_SDL_UpdateSoundParams(int handle, int vol, int sep)
 {
     int left, right;
 
-    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS)
+    if (!sound_initialized || handle < 0 || handle >= num_channels)
     {
         return;
     }
 
-    left = ((254 - sep) * vol) / 127;
-    right = ((sep) * vol) / 127;
-
-    if (left < 0) left = 0;
-    else if ( left > 255) left = 255;
-    if (right < 0) right = 0;
-    else if (right > 255) right = 255;
+    CalculatePanning(vol, sep, &left, &right);
 
-    Mix_SetPanning(handle, left, right);
+    if (native_mixer)
+    {
+        I_NativeMixerSetParams(handle, left, right);
+    }
+    else
+    {
+        Mix_SetPanning(handle, left, right);
+    }
 }
 
 //
@@ -990,7 +1495,7 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
 {
     allocated_sound_t *snd;
 
-    if (!sound_initialized || channel < 0 || channel >= NUM_CHANNELS)
+    if (!sound_initialized || channel < 0 || channel >= num_channels)
     {
         return -1;
     }
@@ -1039,10 +1544,20 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
 
     // play sound
 
-    Mix_PlayChannel(channel, &snd->chunk, 0);
-
     channels_playing[channel] = snd;
 
+    if (native_mixer)
+    {
+        int left, right;
+
+        CalculatePanning(vol, sep, &left, &right);
+        I_NativeMixerPlay(channel, snd->chunk.abuf, snd->chunk.alen / 4,
+                          left, right);
+        return channel;
+    }
+
+    Mix_PlayChannel(channel, &snd->chunk, 0);
+
     // set separation, etc.
 
     I_SDL_UpdateSoundParams(channel, vol, sep);
@@ -1052,7 +1567,7 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
 
 static void I_SDL_StopSound(int handle)
 {
-    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS)
+    if (!sound_initialized || handle < 0 || handle >= num_channels)
     {
         return;
     }
@@ -1066,11 +1581,16 @@ static void I_SDL_StopSound(int handle)
 
 static boolean I_SDL_SoundIsPlaying(int handle)
 {
-    if (!sound_initialized || handle < 0 || handle >= NUM_CHANNELS)
+    if (!sound_initialized || handle < 0 || handle >= num_channels)
     {
         return false;
     }
 
+    if (native_mixer)
+    {
+        return I_NativeMixerIsPlaying(handle);
+    }
+
     return Mix_Playing(handle);
 }
 
@@ -1084,7 +1604,7 @@ static void I_SDL_UpdateSound(void)
 
     // Check all channels to see if a sound has finished
 
-    for (i=0; i<NUM_CHANNELS; ++i)
+    for (i=0; i<num_channels; ++i)
     {
         if (channels_playing[i] && !I_SDL_SoundIsPlaying(i))
         {
@@ -1094,6 +1614,11 @@ static void I_SDL_UpdateSound(void)
             ReleaseSoundOnChannel(i);
         }
     }
+
+    if (released_sounds != NULL)
+    {
+        FreeReleasedSounds(false);
+    }
 }
 
 static void I_SDL_ShutdownSound(void)
@@ -1103,6 +1628,13 @@ static void I_SDL_ShutdownSound(void)
         return;
     }
 
+    if (native_mixer)
+    {
+        I_ShutdownNativeMixer();
+        FreeReleasedSounds(true);
+        native_mixer = false;
+    }
+
     Mix_CloseAudio();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 
@@ -1143,7 +1675,7 @@ static boolean I_SDL_InitSound(GameMission_t mission)
     use_sfx_prefix = (mission == doom || mission == strife);
 
     // No sounds yet
-    for (i=0; i<NUM_CHANNELS; ++i)
+    for (i=0; i<MIXER_MAX_VOICES; ++i)
     {
         channels_playing[i] = NULL;
     }
@@ -1184,7 +1716,14 @@ static boolean I_SDL_InitSound(GameMission_t mission)
     }
 #endif
 
-    Mix_AllocateChannels(NUM_CHANNELS);
+    // [JN] Use the native mixer if requested. SDL_mixer channels are
+    // not needed then, SDL_mixer is only used for the music stream.
+
+    native_mixer = snd_nativemixer && I_InitNativeMixer(mixer_format,
+                                                        mixer_channels);
+    num_channels = native_mixer ? MIXER_MAX_VOICES : NUM_CHANNELS;
+
+    Mix_AllocateChannels(native_mixer ? 0 : NUM_CHANNELS);
 
     SDL_PauseAudio(0);
 
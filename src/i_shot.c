@@ -0,0 +1,665 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Screenshot encoding and frame capture.
+//
+//      The game thread only copies the frame into one of a small pool
+//      of buffers. Applying the palette pane, aspect ratio correction,
+//      PNG compression and writing the file happen on a background
+//      thread, so taking a screenshot does not stall the game.
+//
+//      With -capture, every frame is queued the same way to a few
+//      encoder threads. When all frame buffers are in use, the game
+//      waits for the encoders rather than dropping frames.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_ZLIB_APIS
+#include "miniz.h"
+
+#include "doomtype.h"
+#include "i_shot.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "i_video.h"
+#include "m_argv.h"
+#include "m_fixed.h"
+#include "m_misc.h"
+
+#include "id_vars.h"
+
+
+// Screenshots that can be encoded at the same time. Taking another one
+// waits for the oldest.
+
+#define MAX_SHOTS 2
+
+typedef struct
+{
+    SDL_Thread *thread;
+    pixel_t *frame;
+    int frame_size;     // in pixels
+    int width;
+    int height;
+    int out_height;     // with aspect ratio correction
+    pane_t pane;
+    char *filename;
+} shot_t;
+
+static shot_t shots[MAX_SHOTS];
+static int oldest_shot;
+static boolean shots_initialized = false;
+
+// Color lookup tables for blending the pane into each channel.
+
+static void PaneTables (const pane_t *pane, byte lut[3][256])
+{
+    const int colors[3] = { pane->r, pane->g, pane->b };
+    const int a = pane->a;
+    int i, c, result;
+
+    for (i = 0; i < 3; ++i)
+    {
+        const int p = colors[i];
+
+        for (c = 0; c < 256; ++c)
+        {
+            switch (pane->mode)
+            {
+                case PANE_MOD:
+                    result = c * p / 255;
+                    break;
+                case PANE_BLEND:
+                    result = (p * a + c * (255 - a)) / 255;
+                    break;
+                case PANE_MUL:
+                    result = (c * p + c * (255 - a)) / 255;
+                    break;
+                default:
+                    result = c;
+                    break;
+            }
+
+            lut[i][c] = MIN(result, 255);
+        }
+    }
+}
+
+// Convert an ARGB8888 frame into RGB bytes, with the pane applied.
+// Rows are repeated to stretch the frame with aspect ratio correction.
+
+static void ConvertFrame (const pixel_t *frame, int width, int height,
+                          int out_height, const pane_t *pane, byte *rgb)
+{
+    byte lut[3][256];
+    int x, y;
+
+    PaneTables(pane, lut);
+
+    for (y = 0; y < out_height; ++y)
+    {
+        const pixel_t *src = frame + (y * height / out_height) * width;
+
+        for (x = 0; x < width; ++x)
+        {
+            const pixel_t p = src[x];
+
+            *rgb++ = lut[0][(p >> 16) & 0xff];
+            *rgb++ = lut[1][(p >> 8) & 0xff];
+            *rgb++ = lut[2][p & 0xff];
+        }
+    }
+}
+
+static void WritePNG (const char *filename, const byte *rgb,
+                      int width, int height, int level)
+{
+    size_t png_size = 0;
+    void *png;
+    FILE *handle;
+
+    png = tdefl_write_image_to_png_file_in_memory_ex(rgb, width, height, 3,
+                                                     &png_size, level,
+                                                     MZ_FALSE);
+
+    if (png == NULL)
+    {
+        fprintf(stderr, "WritePNG: couldn't encode %s\n", filename);
+        return;
+    }
+
+    handle = M_fopen(filename, "wb");
+
+    if (handle == NULL)
+    {
+        fprintf(stderr, "WritePNG: couldn't write %s\n", filename);
+    }
+    else
+    {
+        fwrite(png, 1, png_size, handle);
+        fclose(handle);
+    }
+
+    mz_free(png);
+}
+
+static int ShotThread (void *data)
+{
+    shot_t *shot = data;
+    byte *rgb;
+
+    rgb = malloc(shot->width * shot->out_height * 3);
+
+    if (rgb == NULL)
+    {
+        fprintf(stderr, "I_SaveScreenShot: out of memory\n");
+        return 0;
+    }
+
+    ConvertFrame(shot->frame, shot->width, shot->height, shot->out_height,
+                 &shot->pane, rgb);
+    WritePNG(shot->filename, rgb, shot->width, shot->out_height,
+             MZ_DEFAULT_LEVEL);
+    free(rgb);
+
+    return 0;
+}
+
+static void WaitShot (shot_t *shot)
+{
+    if (shot->thread != NULL)
+    {
+        SDL_WaitThread(shot->thread, NULL);
+        shot->thread = NULL;
+    }
+
+    free(shot->filename);
+    shot->filename = NULL;
+}
+
+void I_FinishScreenShots (void)
+{
+    int i;
+
+    for (i = 0; i < MAX_SHOTS; ++i)
+    {
+        WaitShot(&shots[i]);
+    }
+}
+
+void I_SaveScreenShot (const char *filename)
+{
+    shot_t *shot;
+
+    if (!shots_initialized)
+    {
+        I_AtExit(I_FinishScreenShots, true);
+        shots_initialized = true;
+    }
+
+    shot = &shots[oldest_shot];
+    oldest_shot = (oldest_shot + 1) % MAX_SHOTS;
+
+    WaitShot(shot);
+
+    // The buffers are kept, unless the rendering resolution changed.
+
+    if (shot->frame_size != SCREENAREA)
+    {
+        free(shot->frame);
+        shot->frame = malloc(SCREENAREA * sizeof(*shot->frame));
+        shot->frame_size = SCREENAREA;
+
+        if (shot->frame == NULL)
+        {
+            shot->frame_size = 0;
+            fprintf(stderr, "I_SaveScreenShot: out of memory\n");
+            return;
+        }
+    }
+
+    I_ReadScreenFrame(shot->frame, &shot->pane, &shot->out_height);
+    shot->width = SCREENWIDTH;
+    shot->height = SCREENHEIGHT;
+    shot->filename = M_StringDuplicate(filename);
+
+    shot->thread = SDL_CreateThread(ShotThread, "screenshot", shot);
+
+    if (shot->thread == NULL)
+    {
+        ShotThread(shot);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Frame capture
+// -----------------------------------------------------------------------------
+
+#define MAX_CAPTURE_THREADS 4
+
+typedef struct
+{
+    pixel_t *frame;
+    pane_t pane;
+    int sequence;       // order the frames are written to a Y4M stream
+    int number;         // PNG file number
+    int repeat;         // times the frame is written to a Y4M stream
+    boolean busy;       // queued or being encoded
+} capframe_t;
+
+static boolean capturing = false;
+static boolean capture_tics;
+static const char *capture_path;
+static FILE *capture_y4m;
+
+// Size of the captured frames. Capture stops if it changes.
+
+static int capture_width;
+static int capture_height;
+static int capture_out_height;
+
+static capframe_t *capframes;
+static int num_capframes;
+static SDL_Thread *capthreads[MAX_CAPTURE_THREADS];
+static int num_capthreads;
+
+// Frames waiting for an encoder, protected by capture_mutex.
+
+static SDL_mutex *capture_mutex;
+static SDL_cond *queued_cond;
+static SDL_cond *freed_cond;
+static SDL_cond *written_cond;
+static int *capture_queue;
+static int queue_head, queue_count;
+static boolean capture_quit;
+
+static int next_sequence;
+static int next_write;
+static int last_tic;
+
+// Full range BT.601 4:4:4, so that no color resolution is lost.
+
+static void RGBToYUV (const byte *rgb, byte *planes, int size)
+{
+    byte *yp = planes, *up = planes + size, *vp = planes + 2 * size;
+    int i;
+
+    for (i = 0; i < size; ++i, rgb += 3)
+    {
+        const int r = rgb[0], g = rgb[1], b = rgb[2];
+
+        yp[i] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+        up[i] = (-43 * r - 85 * g + 128 * b + 32896) >> 8;
+        vp[i] = (128 * r - 107 * g - 21 * b + 32896) >> 8;
+    }
+}
+
+// Convert a frame, and write it if it goes to a PNG file. Returns
+// false if it could not be converted.
+
+static boolean EncodeCaptureFrame (const capframe_t *f, byte **rgb,
+                                   byte **planes)
+{
+    const int size = capture_width * capture_out_height;
+    char filename[256];
+
+    if (*rgb == NULL)
+    {
+        *rgb = malloc(size * 3);
+    }
+
+    if (capture_y4m != NULL && *planes == NULL)
+    {
+        *planes = malloc(size * 3);
+    }
+
+    if (*rgb == NULL || (capture_y4m != NULL && *planes == NULL))
+    {
+        fprintf(stderr, "I_CaptureFrame: out of memory\n");
+        return false;
+    }
+
+    ConvertFrame(f->frame, capture_width, capture_height,
+                 capture_out_height, &f->pane, *rgb);
+
+    if (capture_y4m != NULL)
+    {
+        RGBToYUV(*rgb, *planes, size);
+    }
+    else
+    {
+        M_snprintf(filename, sizeof(filename), "%s%06d.png",
+                   capture_path, f->number);
+        WritePNG(filename, *rgb, capture_width, capture_out_height,
+                 MZ_BEST_SPEED);
+    }
+
+    return true;
+}
+
+static int CaptureThread (void *unused)
+{
+    byte *rgb = NULL, *planes = NULL;
+    capframe_t *f;
+    boolean ok;
+    int i;
+
+    SDL_LockMutex(capture_mutex);
+
+    while (true)
+    {
+        while (!capture_quit && queue_count == 0)
+        {
+            SDL_CondWait(queued_cond, capture_mutex);
+        }
+
+        // Finish the queued frames before quitting.
+
+        if (queue_count == 0)
+        {
+            break;
+        }
+
+        f = &capframes[capture_queue[queue_head]];
+        queue_head = (queue_head + 1) % num_capframes;
+        --queue_count;
+
+        SDL_UnlockMutex(capture_mutex);
+
+        ok = EncodeCaptureFrame(f, &rgb, &planes);
+
+        // Y4M frames are converted in parallel, but must be written in
+        // order. Only the thread whose turn it is writes to the file.
+
+        if (capture_y4m != NULL)
+        {
+            SDL_LockMutex(capture_mutex);
+
+            while (next_write != f->sequence)
+            {
+                SDL_CondWait(written_cond, capture_mutex);
+            }
+
+            SDL_UnlockMutex(capture_mutex);
+
+            for (i = 0; ok && i < f->repeat; ++i)
+            {
+                fputs("FRAME\n", capture_y4m);
+                fwrite(planes, 1, capture_width * capture_out_height * 3,
+                       capture_y4m);
+            }
+        }
+
+        SDL_LockMutex(capture_mutex);
+
+        ++next_write;
+        SDL_CondBroadcast(written_cond);
+
+        f->busy = false;
+        SDL_CondSignal(freed_cond);
+    }
+
+    SDL_UnlockMutex(capture_mutex);
+
+    free(rgb);
+    free(planes);
+
+    return 0;
+}
+
+void I_StopCapture (void)
+{
+    int i;
+
+    if (!capturing)
+    {
+        return;
+    }
+
+    capturing = false;
+
+    SDL_LockMutex(capture_mutex);
+    capture_quit = true;
+    SDL_CondBroadcast(queued_cond);
+    SDL_UnlockMutex(capture_mutex);
+
+    for (i = 0; i < num_capthreads; ++i)
+    {
+        SDL_WaitThread(capthreads[i], NULL);
+    }
+
+    if (capture_y4m != NULL)
+    {
+        fclose(capture_y4m);
+        capture_y4m = NULL;
+    }
+
+    for (i = 0; i < num_capframes; ++i)
+    {
+        free(capframes[i].frame);
+    }
+
+    free(capframes);
+    free(capture_queue);
+    SDL_DestroyCond(written_cond);
+    SDL_DestroyCond(freed_cond);
+    SDL_DestroyCond(queued_cond);
+    SDL_DestroyMutex(capture_mutex);
+
+    printf("I_StopCapture: %d frames captured to %s\n",
+           next_sequence, capture_path);
+}
+
+void I_InitCapture (void)
+{
+    int i, p;
+
+    //!
+    // @arg <path>
+    // @category video
+    //
+    // Capture every rendered frame. If <path> ends with .y4m, the frames
+    // are written to an uncompressed Y4M video, otherwise to a sequence
+    // of PNG files named <path>000000.png, <path>000001.png and so on.
+    //
+
+    p = M_CheckParmWithArgs("-capture", 1);
+
+    if (p == 0 || capturing)
+    {
+        return;
+    }
+
+    //!
+    // @category video
+    //
+    // With -capture, capture one frame per game tic rather than every
+    // rendered frame. PNG files are numbered by tic, and frames are
+    // repeated in Y4M videos for skipped tics, so that the capture
+    // keeps the timing of a demo. Required for Y4M videos with uncapped
+    // framerate.
+    //
+
+    capture_tics = M_ParmExists("-capturetics");
+    capture_path = myargv[p + 1];
+
+    if (M_StringEndsWith(capture_path, ".y4m"))
+    {
+        // [JN] Rendered frames are written as they come, at whatever rate
+        // the machine manages. Only tics give a Y4M video a known rate.
+
+        if (vid_uncapped_fps && !capture_tics)
+        {
+            I_Error("I_InitCapture: Y4M capture with uncapped framerate "
+                    "needs -capturetics");
+        }
+
+        capture_y4m = M_fopen(capture_path, "wb");
+
+        if (capture_y4m == NULL)
+        {
+            I_Error("I_InitCapture: couldn't open %s", capture_path);
+        }
+    }
+
+    capture_width = SCREENWIDTH;
+    capture_height = SCREENHEIGHT;
+    capture_out_height = 0;
+
+    num_capthreads = SDL_GetCPUCount() - 1;
+    num_capthreads = BETWEEN(1, MAX_CAPTURE_THREADS, num_capthreads);
+
+    // Two more frames than encoders, so that the game can go on with
+    // the next frame while every encoder is busy.
+
+    num_capframes = num_capthreads + 2;
+    capframes = calloc(num_capframes, sizeof(*capframes));
+    capture_queue = calloc(num_capframes, sizeof(*capture_queue));
+
+    if (capframes == NULL || capture_queue == NULL)
+    {
+        I_Error("I_InitCapture: out of memory");
+    }
+
+    for (i = 0; i < num_capframes; ++i)
+    {
+        capframes[i].frame = malloc(SCREENAREA * sizeof(pixel_t));
+
+        if (capframes[i].frame == NULL)
+        {
+            I_Error("I_InitCapture: out of memory");
+        }
+    }
+
+    capture_mutex = SDL_CreateMutex();
+    queued_cond = SDL_CreateCond();
+    freed_cond = SDL_CreateCond();
+    written_cond = SDL_CreateCond();
+    queue_head = queue_count = 0;
+    capture_quit = false;
+    next_sequence = next_write = 0;
+    last_tic = -1;
+
+    for (i = 0; i < num_capthreads; ++i)
+    {
+        capthreads[i] = SDL_CreateThread(CaptureThread, "capture", NULL);
+
+        if (capthreads[i] == NULL)
+        {
+            I_Error("I_InitCapture: %s", SDL_GetError());
+        }
+    }
+
+    capturing = true;
+    I_AtExit(I_StopCapture, true);
+}
+
+void I_CaptureFrame (int tic)
+{
+    capframe_t *f;
+    int repeat, number;
+    int i;
+
+    if (!capturing)
+    {
+        return;
+    }
+
+    if (capture_tics)
+    {
+        if (tic == last_tic)
+        {
+            return;
+        }
+
+        repeat = last_tic < 0 ? 1 : tic - last_tic;
+        number = tic;
+        last_tic = tic;
+    }
+    else
+    {
+        repeat = 1;
+        number = next_sequence;
+    }
+
+    if (SCREENWIDTH != capture_width || SCREENHEIGHT != capture_height)
+    {
+        fprintf(stderr, "I_CaptureFrame: rendering resolution changed\n");
+        I_StopCapture();
+        return;
+    }
+
+    // Wait for a free frame buffer.
+
+    SDL_LockMutex(capture_mutex);
+
+    while (true)
+    {
+        for (i = 0; i < num_capframes; ++i)
+        {
+            if (!capframes[i].busy)
+            {
+                break;
+            }
+        }
+
+        if (i < num_capframes)
+        {
+            break;
+        }
+
+        SDL_CondWait(freed_cond, capture_mutex);
+    }
+
+    f = &capframes[i];
+    f->busy = true;
+
+    SDL_UnlockMutex(capture_mutex);
+
+    I_ReadScreenFrame(f->frame, &f->pane, &i);
+
+    if (capture_out_height == 0)
+    {
+        capture_out_height = i;
+
+        if (capture_y4m != NULL)
+        {
+            fprintf(capture_y4m, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+                    capture_width, capture_out_height, TICRATE);
+        }
+    }
+    else if (i != capture_out_height)
+    {
+        fprintf(stderr, "I_CaptureFrame: aspect ratio changed\n");
+        f->busy = false;
+        I_StopCapture();
+        return;
+    }
+
+    f->sequence = next_sequence++;
+    f->number = number;
+    f->repeat = repeat;
+
+    SDL_LockMutex(capture_mutex);
+    capture_queue[(queue_head + queue_count) % num_capframes] = f - capframes;
+    ++queue_count;
+    SDL_CondSignal(queued_cond);
+    SDL_UnlockMutex(capture_mutex);
+}
@@ -0,0 +1,40 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Screenshot encoding and frame capture.
+//
+
+
+#ifndef __I_SHOT__
+#define __I_SHOT__
+
+// Save the current frame as a PNG file. The frame is copied right away,
+// it is converted, compressed and written on a background thread.
+void I_SaveScreenShot (const char *filename);
+
+// Wait until all screenshots have been written.
+void I_FinishScreenShots (void);
+
+// Start capturing frames if -capture is given.
+void I_InitCapture (void);
+
+// Queue the current frame for capture. Called for every presented
+// frame with the current game tic. Blocks while all frame buffers are
+// waiting to be encoded.
+void I_CaptureFrame (int tic);
+
+// Finish writing the captured frames.
+void I_StopCapture (void);
+
+#endif
@@ -18,7 +18,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "SDL.h"
 #include "SDL_mixer.h"
 
 #include "config.h"
@@ -28,6 +30,8 @@
 #include "i_video.h"
 #include "m_argv.h"
 #include "m_config.h"
+#include "memio.h"
+#include "mus2mid.h"
 
 // Sound sample rate to use for digital output (Hz)
 
@@ -52,6 +56,10 @@ char *snd_musiccmd = "";
 
 int snd_pitchshift = 1;
 
+// [JN] Mix sound effects with the native mixer instead of SDL_mixer channels.
+
+int snd_nativemixer = 0;
+
 int snd_musicdevice = SNDDEVICE_SB;
 int snd_sfxdevice = SNDDEVICE_SB;
 
@@ -63,6 +71,21 @@ static const music_module_t *music_module;
 // depending on whether the current track is substituted.
 static const music_module_t *active_music_module;
 
+// [JN] Song prefetch: the next song is registered ahead of time on a
+// loader thread, and handed over when it is actually played.
+
+static SDL_Thread *prefetch_thread;
+static const music_module_t *prefetch_module;
+static void *prefetch_data;
+static int prefetch_len;
+static void *prefetch_handle;
+
+// [JN] MUS song converted to MIDI for the SDL module. The conversion
+// uses zone memory, so it is done before the loader thread starts.
+
+static void *prefetch_midi;
+static size_t prefetch_midi_len;
+
 // Compiled-in sound modules:
 
 static const sound_module_t *sound_modules[] =
@@ -253,6 +276,8 @@ void I_InitSound(GameMission_t mission)
 
 void I_ShutdownSound(void)
 {
+    I_CancelPrefetchSong();
+
     if (sound_module != NULL)
     {
         sound_module->Shutdown();
@@ -425,20 +450,168 @@ boolean IsMus(byte *mem, int len)
     return len > 4 && !memcmp(mem, "MUS\x1a", 4);
 }
 
-void *I_RegisterSong(void *data, int len)
+// Module that plays the given song data.
+
+static const music_module_t *ModuleForSong(void *data, int len)
 {
     if (!IsMid(data, len) && !IsMus(data, len))
     {
 #ifndef DISABLE_SDL2MIXER
-        active_music_module = &music_sdl_module;
-        return active_music_module->RegisterSong(data, len);
+        return &music_sdl_module;
 #else
         return NULL;
 #endif
     }
 
     // No substitution for this track, so use the main module.
-    active_music_module = music_module;
+    return music_module;
+}
+
+static int PrefetchThread(void *unused)
+{
+    if (prefetch_midi != NULL)
+    {
+        prefetch_handle = prefetch_module->RegisterSong(
+                              prefetch_midi, (int) prefetch_midi_len);
+    }
+    else
+    {
+        prefetch_handle = prefetch_module->RegisterSong(prefetch_data,
+                                                        prefetch_len);
+    }
+
+    return 0;
+}
+
+static void WaitPrefetchSong(void)
+{
+    if (prefetch_thread != NULL)
+    {
+        SDL_WaitThread(prefetch_thread, NULL);
+        prefetch_thread = NULL;
+    }
+
+    free(prefetch_midi);
+    prefetch_midi = NULL;
+}
+
+// [JN] Convert a MUS song to a MIDI buffer of its own, allocated with
+// malloc. Returns NULL if the song can't be converted.
+
+static void *ConvertMusToMidi(void *data, int len, size_t *midi_len)
+{
+    MEMFILE *instream;
+    MEMFILE *outstream;
+    void *outbuf;
+    void *midi = NULL;
+
+    instream = mem_fopen_read(data, len);
+    outstream = mem_fopen_write();
+
+    if (!mus2mid(instream, outstream))
+    {
+        mem_get_buf(outstream, &outbuf, midi_len);
+        midi = malloc(*midi_len);
+
+        if (midi != NULL)
+        {
+            memcpy(midi, outbuf, *midi_len);
+        }
+    }
+
+    mem_fclose(instream);
+    mem_fclose(outstream);
+
+    return midi;
+}
+
+// [JN] Start registering a song on a loader thread. The data must stay
+// valid until the song is played or the prefetch is cancelled. Only
+// the SDL and OPL modules are known to register songs independently
+// of the one that is playing, other modules are left alone.
+
+void I_PrefetchSong(void *data, int len)
+{
+    const music_module_t *module;
+
+    I_CancelPrefetchSong();
+
+    module = ModuleForSong(data, len);
+
+    if (module != &music_opl_module
+#ifndef DISABLE_SDL2MIXER
+     && (module != &music_sdl_module || strlen(snd_musiccmd) > 0)
+#endif
+    )
+    {
+        return;
+    }
+
+#ifndef DISABLE_SDL2MIXER
+    // [JN] The loader thread must not touch zone memory, so only the
+    // MIDI data is handed to it and the module just loads the file.
+
+    if (module == &music_sdl_module && IsMus(data, len))
+    {
+        prefetch_midi = ConvertMusToMidi(data, len, &prefetch_midi_len);
+
+        if (prefetch_midi == NULL)
+        {
+            return;
+        }
+    }
+#endif
+
+    prefetch_module = module;
+    prefetch_data = data;
+    prefetch_len = len;
+    prefetch_handle = NULL;
+
+    prefetch_thread = SDL_CreateThread(PrefetchThread, "music loader", NULL);
+
+    if (prefetch_thread == NULL)
+    {
+        free(prefetch_midi);
+        prefetch_midi = NULL;
+        prefetch_module = NULL;
+    }
+}
+
+void I_CancelPrefetchSong(void)
+{
+    WaitPrefetchSong();
+
+    if (prefetch_module != NULL && prefetch_handle != NULL)
+    {
+        prefetch_module->UnRegisterSong(prefetch_handle);
+    }
+
+    prefetch_module = NULL;
+    prefetch_data = NULL;
+    prefetch_handle = NULL;
+}
+
+void *I_RegisterSong(void *data, int len)
+{
+    // [JN] Never register two songs at once. Take the prefetched song
+    // if it is the one requested.
+
+    WaitPrefetchSong();
+
+    if (prefetch_module != NULL && prefetch_data == data
+     && prefetch_len == len)
+    {
+        void *handle = prefetch_handle;
+
+        active_music_module = prefetch_module;
+        prefetch_module = NULL;
+        prefetch_data = NULL;
+        prefetch_handle = NULL;
+
+        return handle;
+    }
+
+    active_music_module = ModuleForSong(data, len);
     if (active_music_module != NULL)
     {
         return active_music_module->RegisterSong(data, len);
@@ -451,6 +624,8 @@ void *I_RegisterSong(void *data, int len)
 
 void I_UnRegisterSong(void *handle)
 {
+    WaitPrefetchSong();
+
     if (active_music_module != NULL)
     {
         active_music_module->UnRegisterSong(handle);
@@ -496,6 +671,7 @@ void I_BindSoundVariables(void)
     M_BindIntVariable("snd_cachesize",           &snd_cachesize);
     M_BindIntVariable("opl_io_port",             &opl_io_port);
     M_BindIntVariable("snd_pitchshift",          &snd_pitchshift);
+    M_BindIntVariable("snd_nativemixer",         &snd_nativemixer);
 
     M_BindStringVariable("timidity_cfg_path",    &timidity_cfg_path);
 #ifdef _WIN32
@@ -226,6 +226,8 @@ void I_PauseSong(void);
 void I_ResumeSong(void);
 void *I_RegisterSong(void *data, int len);
 void I_UnRegisterSong(void *handle);
+void I_PrefetchSong(void *data, int len);
+void I_CancelPrefetchSong(void);
 void I_PlaySong(void *handle, boolean looping);
 void I_StopSong(void);
 boolean I_MusicIsPlaying(void);
@@ -240,6 +242,7 @@ extern int snd_cachesize;
 extern int snd_maxslicetime_ms;
 extern char *snd_musiccmd;
 extern int snd_pitchshift;
+extern int snd_nativemixer;
 extern char *snd_dmxoption;
 extern int use_libsamplerate;
 extern float libsamplerate_scale;
@@ -0,0 +1,274 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#include "i_system.h"
+#include "i_thread.h"
+#include "m_argv.h"
+
+
+#define MAX_WORKERS 16
+
+static boolean threads_initialized = false;
+
+static SDL_Thread *workers[MAX_WORKERS];
+static int num_workers;
+
+static SDL_mutex *pool_mutex;
+static SDL_cond *work_cond;
+static SDL_cond *done_cond;
+static boolean pool_quit;
+
+// Currently running job. Every call of I_ParallelFor bumps
+// job_generation, which wakes up the workers.
+
+static parallel_func_t job_func;
+static void *job_data;
+static int job_count;
+static int job_generation;
+static int workers_busy;
+static SDL_atomic_t job_next;
+
+static void RunJobs(void)
+{
+    int i;
+
+    while ((i = SDL_AtomicAdd(&job_next, 1)) < job_count)
+    {
+        job_func(i, job_data);
+    }
+}
+
+static int WorkerThread(void *unused)
+{
+    int generation = 0;
+
+    SDL_LockMutex(pool_mutex);
+
+    while (true)
+    {
+        while (!pool_quit && generation == job_generation)
+        {
+            SDL_CondWait(work_cond, pool_mutex);
+        }
+
+        if (pool_quit)
+        {
+            break;
+        }
+
+        generation = job_generation;
+        SDL_UnlockMutex(pool_mutex);
+
+        RunJobs();
+
+        SDL_LockMutex(pool_mutex);
+
+        if (--workers_busy == 0)
+        {
+            SDL_CondSignal(done_cond);
+        }
+    }
+
+    SDL_UnlockMutex(pool_mutex);
+
+    return 0;
+}
+
+void I_InitThreads(void)
+{
+    int i;
+
+    if (threads_initialized)
+    {
+        return;
+    }
+
+    threads_initialized = true;
+    num_workers = 0;
+
+    //!
+    // @category obscure
+    //
+    // Do not use worker threads, run all jobs on the main thread.
+    //
+
+    if (M_CheckParm("-nothreads"))
+    {
+        return;
+    }
+
+    pool_mutex = SDL_CreateMutex();
+    work_cond = SDL_CreateCond();
+    done_cond = SDL_CreateCond();
+    pool_quit = false;
+    job_generation = 0;
+
+    for (i = 0; i < SDL_GetCPUCount() - 1 && i < MAX_WORKERS; ++i)
+    {
+        workers[i] = SDL_CreateThread(WorkerThread, "worker", NULL);
+
+        if (workers[i] == NULL)
+        {
+            fprintf(stderr, "I_InitThreads: %s\n", SDL_GetError());
+            break;
+        }
+
+        ++num_workers;
+    }
+
+    I_AtExit(I_ShutdownThreads, true);
+}
+
+void I_ShutdownThreads(void)
+{
+    int i;
+
+    if (!threads_initialized || pool_mutex == NULL)
+    {
+        return;
+    }
+
+    SDL_LockMutex(pool_mutex);
+    pool_quit = true;
+    SDL_CondBroadcast(work_cond);
+    SDL_UnlockMutex(pool_mutex);
+
+    for (i = 0; i < num_workers; ++i)
+    {
+        SDL_WaitThread(workers[i], NULL);
+    }
+
+    SDL_DestroyCond(done_cond);
+    SDL_DestroyCond(work_cond);
+    SDL_DestroyMutex(pool_mutex);
+    pool_mutex = NULL;
+
+    num_workers = 0;
+}
+
+int I_NumThreads(void)
+{
+    I_InitThreads();
+
+    return num_workers + 1;
+}
+
+void I_ParallelFor(int count, parallel_func_t func, void *data)
+{
+    int i;
+
+    I_InitThreads();
+
+    if (num_workers == 0 || count <= 1)
+    {
+        for (i = 0; i < count; ++i)
+        {
+            func(i, data);
+        }
+        return;
+    }
+
+    SDL_LockMutex(pool_mutex);
+    job_func = func;
+    job_data = data;
+    job_count = count;
+    SDL_AtomicSet(&job_next, 0);
+    workers_busy = num_workers;
+    ++job_generation;
+    SDL_CondBroadcast(work_cond);
+    SDL_UnlockMutex(pool_mutex);
+
+    RunJobs();
+
+    SDL_LockMutex(pool_mutex);
+
+    while (workers_busy > 0)
+    {
+        SDL_CondWait(done_cond, pool_mutex);
+    }
+
+    SDL_UnlockMutex(pool_mutex);
+}
+
+struct background_s
+{
+    SDL_Thread *thread;
+    SDL_atomic_t done;
+    void (*func)(void *data);
+    void *data;
+};
+
+static int BackgroundThread(void *arg)
+{
+    background_t *job = arg;
+
+    job->func(job->data);
+    SDL_AtomicSet(&job->done, 1);
+
+    return 0;
+}
+
+background_t *I_StartBackground(void (*func)(void *data), void *data)
+{
+    background_t *job;
+
+    I_InitThreads();
+
+    job = malloc(sizeof(*job));
+
+    if (job == NULL)
+    {
+        I_Error("I_StartBackground: out of memory");
+    }
+
+    job->thread = NULL;
+    job->func = func;
+    job->data = data;
+    SDL_AtomicSet(&job->done, 0);
+
+    if (num_workers > 0)
+    {
+        job->thread = SDL_CreateThread(BackgroundThread, "background", job);
+    }
+
+    if (job->thread == NULL)
+    {
+        BackgroundThread(job);
+    }
+
+    return job;
+}
+
+boolean I_BackgroundDone(background_t *job)
+{
+    return SDL_AtomicGet(&job->done) != 0;
+}
+
+void I_WaitBackground(background_t *job)
+{
+    if (job->thread != NULL)
+    {
+        SDL_WaitThread(job->thread, NULL);
+    }
+
+    free(job);
+}
@@ -0,0 +1,55 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+#include "doomtype.h"
+
+typedef void (*parallel_func_t)(int index, void *data);
+
+// Start the worker threads. Called on first use.
+void I_InitThreads(void);
+
+// Stop the worker threads.
+void I_ShutdownThreads(void);
+
+// Number of threads that run parallel jobs, including the caller.
+int I_NumThreads(void);
+
+// Call func(i, data) for every i in 0..count-1, spread across the
+// worker threads, and wait until all calls have finished. The calling
+// thread takes part in the work. Must only be called from the main
+// thread, and jobs must not touch the zone memory or the WAD cache.
+void I_ParallelFor(int count, parallel_func_t func, void *data);
+
+typedef struct background_s background_t;
+
+// Call func(data) on a thread of its own and return a handle to wait
+// for it. Without worker threads (-nothreads or a single CPU), the call
+// is made right away on the calling thread. The same rules as for
+// I_ParallelFor apply to the job.
+background_t *I_StartBackground(void (*func)(void *data), void *data);
+
+// Whether a background job has finished, so that waiting won't block.
+boolean I_BackgroundDone(background_t *job);
+
+// Wait for a background job to finish, and free the handle.
+void I_WaitBackground(background_t *job);
+
+#endif
@@ -88,6 +88,51 @@ void I_WaitVBL(int count)
     I_Sleep((count * 1000) / 70);
 }
 
+// [JN] How much later than asked SDL_Delay returns, in microseconds.
+// Follows the measured oversleep, rising at once and falling slowly.
+
+#define MAX_SLEEP_SLACK 8000
+
+static uint64_t sleep_slack = 2000;
+
+static void CalibrateSlack(uint64_t asked, uint64_t slept)
+{
+    const uint64_t over = slept > asked ? slept - asked : 0;
+
+    if (over >= sleep_slack)
+    {
+        sleep_slack = MIN(over, MAX_SLEEP_SLACK);
+    }
+    else
+    {
+        sleep_slack -= (sleep_slack - over) / 16;
+    }
+}
+
+// [JN] Wait until the given I_GetTimeUS time. Sleep while the timer
+// slack allows it, and spin for the rest, so that the wait ends on
+// time without keeping a CPU core busy for all of it.
+
+void I_WaitUntilUS(uint64_t deadline)
+{
+    uint64_t now = I_GetTimeUS();
+
+    while (now + sleep_slack + 1000 <= deadline)
+    {
+        const int ms = (int) ((deadline - now - sleep_slack) / 1000);
+        const uint64_t before = now;
+
+        SDL_Delay(ms);
+        now = I_GetTimeUS();
+        CalibrateSlack(ms * 1000ull, now - before);
+    }
+
+    while (now < deadline)
+    {
+        now = I_GetTimeUS();
+    }
+}
+
 
 void I_InitTimer(void)
 {
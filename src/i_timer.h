@@ -38,6 +38,9 @@ uint64_t I_GetTimeUS(void); // [crispy]
 // Pause for a specified number of ms
 void I_Sleep(int ms);
 
+// [JN] Pause until the given time in us
+void I_WaitUntilUS(uint64_t deadline);
+
 // Initialize timer
 void I_InitTimer(void);
 
@@ -26,30 +26,6 @@
 #include "id_vars.h"
 
 
-// =============================================================================
-//
-//                       Blending initialization functions
-//
-// =============================================================================
-
-// -----------------------------------------------------------------------------
-// TrueColor blending. 
-//
-// [PN] Initializes a 511-entry 1D saturation LUT for additive blending.
-// The LUT maps all possible sums of two 8-bit color channels (0..255 + 0..255),
-// clamping any result above 255 to 255.
-// -----------------------------------------------------------------------------
-
-uint8_t additive_lut_32[511];
-
-void I_InitTCTransMaps (void)
-{
-    for (int i = 0; i < 511; ++i)
-    {
-        additive_lut_32[i] = (uint8_t)(i > 255 ? 255 : i);
-    }
-}
-
 // [JN] Shade factor used for menu and automap background shading.
 const int I_ShadeFactor[] =
 {
@@ -25,11 +25,6 @@
 #include "config.h"
 
 
-// TrueColor blending:
-extern uint8_t additive_lut_32[511];
-
-extern void I_InitTCTransMaps (void);
-
 // Color corrections:
 extern const int I_ShadeFactor[];
 extern const float I_SaturationPercent[];
@@ -46,13 +41,23 @@ extern const double colorblind_matrix[][3][3];
 // I_BlendAdd
 //
 
+// [JN] Saturating add of packed channels, no table lookups. R and B are
+// summed in one register and G in another, each sum has a spare bit above
+// its channel. Lanes that carried into it are filled with 0xFF by
+// subtracting the carry shifted down by eight.
+
 #define I_BlendAdd_32(bg, fg) ( \
     (0xFF000000U) | \
-    (additive_lut_32[((bg) & 0xFF) + ((fg) & 0xFF)]) |                     \
-    (additive_lut_32[(((bg) & 0xFF00) + ((fg) & 0xFF00)) >> 8] << 8) |     \
-    (additive_lut_32[(((bg) & 0xFF0000) + ((fg) & 0xFF0000)) >> 16] << 16) \
+    I_SaturateRB_32(((bg) & 0xFF00FF) + ((fg) & 0xFF00FF)) | \
+    I_SaturateG_32(((bg) & 0x00FF00) + ((fg) & 0x00FF00))    \
 )
 
+#define I_SaturateRB_32(sum) \
+    (((sum) | (((sum) & 0x1000100) - (((sum) & 0x1000100) >> 8))) & 0xFF00FF)
+
+#define I_SaturateG_32(sum) \
+    (((sum) | (((sum) & 0x10000) - (((sum) & 0x10000) >> 8))) & 0x00FF00)
+
 #define I_BlendAdd_8(bg, fg) \
 ( \
     pal_color[ RGB_TO_PAL( \
@@ -239,6 +244,53 @@ extern const double colorblind_matrix[][3][3];
 )
 
 
+// -----------------------------------------------------------------------------
+//
+//                   Blending lambdas for pairs of pixels
+//
+// -----------------------------------------------------------------------------
+
+//
+// [JN] Two pixels packed in a 64-bit word, the first one in the low half.
+// Every channel keeps eight spare bits above it, so the fixed alpha and
+// additive blends above work on both pixels at once. Used by the low
+// detail drawers, which blend two neighbouring columns with one color.
+//
+
+#define I_PackPair_32(lo, hi) ((uint64_t)(lo) | ((uint64_t)(hi) << 32))
+#define I_SplatPair_32(px)    ((uint64_t)(px) * 0x100000001ULL)
+
+#define I_PairRB_32 0x00FF00FF00FF00FFULL
+#define I_PairG_32  0x0000FF000000FF00ULL
+#define I_PairA_32  0xFF000000FF000000ULL
+
+#define I_BlendOver64_32x2(bg, fg) ( \
+    (I_PairA_32) | \
+    (((((fg) & I_PairRB_32) + ((bg) & I_PairRB_32) * 3) >> 2) & I_PairRB_32) | \
+    (((((fg) & I_PairG_32)  + ((bg) & I_PairG_32)  * 3) >> 2) & I_PairG_32)    \
+)
+
+#define I_BlendOver168_32x2(bg, fg) ( \
+    (I_PairA_32) | \
+    (((((fg) & I_PairRB_32) * 3 + ((bg) & I_PairRB_32)) >> 2) & I_PairRB_32) | \
+    (((((fg) & I_PairG_32)  * 3 + ((bg) & I_PairG_32))  >> 2) & I_PairG_32)    \
+)
+
+#define I_BlendAdd_32x2(bg, fg) ( \
+    (I_PairA_32) | \
+    I_SaturateRB_32x2(((bg) & I_PairRB_32) + ((fg) & I_PairRB_32)) | \
+    I_SaturateG_32x2(((bg) & I_PairG_32) + ((fg) & I_PairG_32))      \
+)
+
+#define I_SaturateRB_32x2(sum) \
+    (((sum) | (((sum) & 0x0100010001000100ULL) - \
+              (((sum) & 0x0100010001000100ULL) >> 8))) & I_PairRB_32)
+
+#define I_SaturateG_32x2(sum) \
+    (((sum) | (((sum) & 0x0001000000010000ULL) - \
+              (((sum) & 0x0001000000010000ULL) >> 8))) & I_PairG_32)
+
+
 // -----------------------------------------------------------------------------
 //
 //     All original human-readable blending functions from Crispy and Inter
@@ -36,7 +36,9 @@
 #include "doomtype.h"
 #include "i_input.h"
 #include "i_joystick.h"
+#include "i_shot.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "i_timer.h"
 #include "i_video.h"
 #include "m_argv.h"
@@ -85,29 +87,37 @@ static SDL_Texture *texture_upscaled = NULL;
 // palette
 
 static SDL_Texture *curpane = NULL;
-// Red palette
-static SDL_Texture *palette_01 = NULL;
-static SDL_Texture *palette_02 = NULL;
-static SDL_Texture *palette_03 = NULL;
-static SDL_Texture *palette_04 = NULL;
-static SDL_Texture *palette_05 = NULL;
-static SDL_Texture *palette_06 = NULL;
-static SDL_Texture *palette_07 = NULL;
-static SDL_Texture *palette_08 = NULL;
-static SDL_Texture *palette_09 = NULL;
-static SDL_Texture *palette_10 = NULL;
-static SDL_Texture *palette_11 = NULL;
-static SDL_Texture *palette_12 = NULL;
-static SDL_Texture *palette_13 = NULL;
-static SDL_Texture *palette_14 = NULL;
-static SDL_Texture *palette_15 = NULL;
-static SDL_Texture *palette_16 = NULL;
-// Yellow palette
-static SDL_Texture *palette_17 = NULL; int yel_pane_alpha;
-// Green palette
-static SDL_Texture *palette_18 = NULL;
-// Yellow + green (bonus+rad)
-static SDL_Texture *palette_19 = NULL;
+static int curpane_index = 0;
+static SDL_Texture *panes[NUMPANES];
+int yel_pane_alpha;
+
+// [JN] Colors and blend modes of the palette panes.
+static const pane_t pane_colors[NUMPANES] = {
+    { PANE_NONE,    0,   0,   0 },
+    // Red palettes
+    { PANE_MOD,   255, 240, 240 },
+    { PANE_MOD,   255, 225, 225 },
+    { PANE_MOD,   255, 210, 210 },
+    { PANE_MOD,   255, 195, 195 },
+    { PANE_MOD,   255, 180, 180 },
+    { PANE_MOD,   255, 165, 165 },
+    { PANE_MOD,   255, 150, 150 },
+    { PANE_MOD,   255, 135, 135 },
+    { PANE_MOD,   255, 120, 120 },
+    { PANE_MOD,   255, 105, 105 },
+    { PANE_MOD,   255,  90,  90 },
+    { PANE_MOD,   255,  75,  75 },
+    { PANE_MOD,   255,  60,  60 },
+    { PANE_MOD,   255,  45,  45 },
+    { PANE_MOD,   255,  30,  30 },
+    { PANE_MOD,   255,  15,  15 },
+    // Yellow palette
+    { PANE_BLEND, 255, 164,   0 },
+    // Green palette
+    { PANE_MUL,    64, 255,   0 },
+    // Yellow + green (bonus+rad)
+    { PANE_MUL,   191, 255,   0 },
+};
 
 static int pane_alpha;
 
@@ -192,6 +202,22 @@ int vid_vga_porch_flash = false;
 
 int vid_force_software_renderer = false;
 
+// [JN] Draw the frame right into the locked streaming texture, instead
+// of copying argbbuffer into the texture every frame.
+
+static int vid_lock_texture = false;
+static boolean texture_lock_failed = false;
+static boolean texture_locked = false;
+
+// [JN] Gamma correction is applied to the frame on its way to the
+// texture, through a table per color channel. The frame itself stays
+// uncorrected, so it is converted into a buffer of its own.
+
+static pixel_t gamma_lut[3][256];
+static int gamma_level = -1;
+static pixel_t *gammabuffer = NULL;
+static int gammabuffer_area = 0;
+
 // Grab the mouse? (int type for config code). nograbmouse_override allows
 // this to be temporarily disabled via the command line.
 
@@ -225,6 +251,11 @@ static boolean noblit;
 
 static grabmouse_callback_t mouse_grab_callback = NULL;
 
+// [JN] Callback function to invoke when I_VideoBuffer moves, so that
+// pointers into it can be updated.
+
+static videobuffer_callback_t video_buffer_callback = NULL;
+
 // Does the window currently have focus?
 
 boolean window_focused = true;
@@ -297,6 +328,24 @@ void I_SetGrabMouseCallback(grabmouse_callback_t func)
     mouse_grab_callback = func;
 }
 
+void I_SetVideoBufferCallback(videobuffer_callback_t func)
+{
+    video_buffer_callback = func;
+}
+
+// [JN] Point I_VideoBuffer at the pixels of argbbuffer, which have moved.
+
+static void MoveVideoBuffer (void)
+{
+    I_VideoBuffer = argbbuffer->pixels;
+    V_RestoreBuffer();
+
+    if (video_buffer_callback != NULL)
+    {
+        video_buffer_callback();
+    }
+}
+
 static void SetShowCursor(boolean show)
 {
     if (!screensaver_mode)
@@ -314,6 +363,12 @@ void I_ShutdownGraphics(void)
     {
         SetShowCursor(true);
 
+        if (texture_locked)
+        {
+            SDL_UnlockTexture(texture);
+            texture_locked = false;
+        }
+
         SDL_FreeSurface(argbbuffer);
         SDL_DestroyTexture(texture_upscaled);
         SDL_DestroyTexture(texture);
@@ -654,6 +709,12 @@ void I_GetEvent(void)
                 }
                 break;
 
+            // [JN] Texture contents may be lost, upload the whole frame.
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                V_MarkScreen();
+                break;
+
             default:
                 break;
         }
@@ -683,6 +744,116 @@ void I_StartTic (void)
     }
 }
 
+// -----------------------------------------------------------------------------
+// Frame statistics
+//  [JN] With -framestats, the intervals between presented frames are
+//  counted in 0.1 ms steps, along with the time from reading the mouse
+//  to presenting the frame that uses it. Both are printed at exit.
+// -----------------------------------------------------------------------------
+
+#define PRESENT_BUCKETS 500  // up to 50 ms, longer ones share the last
+
+static boolean frame_stats = false;
+static unsigned int present_hist[PRESENT_BUCKETS + 1];
+static unsigned int present_count;
+static uint64_t present_sum;
+static uint64_t last_present_time;
+static uint64_t input_time;
+static uint64_t latency_sum;
+static uint64_t latency_max;
+static unsigned int latency_count;
+
+static void RecordPresent (void)
+{
+    const uint64_t now = I_GetTimeUS();
+
+    if (last_present_time != 0)
+    {
+        const uint64_t interval = now - last_present_time;
+
+        ++present_hist[MIN(interval / 100, PRESENT_BUCKETS)];
+        present_sum += interval;
+        ++present_count;
+    }
+
+    last_present_time = now;
+
+    if (input_time != 0)
+    {
+        const uint64_t latency = now - input_time;
+
+        latency_sum += latency;
+        latency_max = MAX(latency, latency_max);
+        ++latency_count;
+        input_time = 0;
+    }
+}
+
+// Upper end of the bucket the given fraction of intervals falls into.
+
+static double PresentPercentile (double fraction)
+{
+    unsigned int count = 0;
+    int i;
+
+    for (i = 0; i < PRESENT_BUCKETS; ++i)
+    {
+        count += present_hist[i];
+
+        if (count >= fraction * present_count)
+        {
+            break;
+        }
+    }
+
+    return (i + 1) / 10.0;
+}
+
+static void PrintFrameStats (void)
+{
+    if (present_count == 0)
+    {
+        return;
+    }
+
+    printf("\nFrame statistics (%u frames)\n", present_count);
+    printf("present interval: mean %.2f ms, median %.1f ms, "
+           "99%% %.1f ms, 99.9%% %.1f ms\n",
+           present_sum / 1000.0 / present_count,
+           PresentPercentile(0.5), PresentPercentile(0.99),
+           PresentPercentile(0.999));
+
+    if (latency_count > 0)
+    {
+        printf("input to present: mean %.2f ms, max %.2f ms\n",
+               latency_sum / 1000.0 / latency_count, latency_max / 1000.0);
+    }
+
+    printf("\n%-12s %10s %8s\n", "interval", "frames", "share");
+
+    for (int i = 0; i <= PRESENT_BUCKETS; ++i)
+    {
+        char interval[16];
+
+        if (present_hist[i] == 0)
+        {
+            continue;
+        }
+
+        if (i == PRESENT_BUCKETS)
+        {
+            M_snprintf(interval, sizeof(interval), ">= %.1f ms", i / 10.0);
+        }
+        else
+        {
+            M_snprintf(interval, sizeof(interval), "%.1f ms", i / 10.0);
+        }
+
+        printf("%-12s %10u %7.2f%%\n", interval, present_hist[i],
+               100.0 * present_hist[i] / present_count);
+    }
+}
+
 void I_UpdateFracTic(void) // [crispy]
 {
     // [AM] Figure out how far into the current tic we're in as a fixed_t.
@@ -691,6 +862,12 @@ void I_UpdateFracTic(void) // [crispy]
 
 void I_StartDisplay(void) // [crispy]
 {
+    // [JN] Start of the input to present time for -framestats.
+    if (frame_stats && input_time == 0)
+    {
+        input_time = I_GetTimeUS();
+    }
+
     SDL_PumpEvents();
 
     if (usemouse && !nomouse && window_focused)
@@ -885,6 +1062,245 @@ static void CreateUpscaledTexture(boolean force)
 //      range of [0.0, 1.0).  Used for interpolation.
 fixed_t fractionaltic;
 
+// -----------------------------------------------------------------------------
+// LockTextureBuffer
+//  [JN] Make argbbuffer use the pixels of the locked streaming texture.
+//  SDL only promises the locked pixels to be write-only, but the OpenGL
+//  and software renderers keep them at the same address from one lock
+//  to the next. This is checked with a test pattern, as the game relies
+//  on the frame being kept, e.g. for the status bar. Other renderers
+//  keep copying argbbuffer into the texture.
+// -----------------------------------------------------------------------------
+
+static void LockTextureBuffer (void)
+{
+    SDL_Surface *surface;
+    pixel_t *pixels, *check;
+    int pitch, check_pitch;
+    int i;
+
+    if (!vid_lock_texture || texture_lock_failed || texture_locked
+     || texture == NULL || vid_gamma != GAMMAOFF)
+    {
+        return;
+    }
+
+    if (SDL_LockTexture(texture, NULL, (void **) &pixels, &pitch) < 0)
+    {
+        texture_lock_failed = true;
+        return;
+    }
+
+    if (pitch == SCREENWIDTH * sizeof(pixel_t))
+    {
+        for (i = 0; i < SCREENAREA; i++)
+        {
+            pixels[i] = i * 2654435761U;
+        }
+
+        SDL_UnlockTexture(texture);
+
+        if (SDL_LockTexture(texture, NULL, (void **) &check, &check_pitch) < 0)
+        {
+            texture_lock_failed = true;
+            return;
+        }
+
+        for (i = 0; i < SCREENAREA; i++)
+        {
+            if (check[i] != (pixel_t) (i * 2654435761U))
+            {
+                break;
+            }
+        }
+
+        if (check == pixels && check_pitch == pitch && i == SCREENAREA)
+        {
+            surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels,
+                          SCREENWIDTH, SCREENHEIGHT, 32, pitch,
+                          SDL_PIXELFORMAT_ARGB8888);
+
+            if (surface != NULL)
+            {
+                memcpy(pixels, argbbuffer->pixels, SCREENAREA * sizeof(*pixels));
+                SDL_FreeSurface(argbbuffer);
+                argbbuffer = surface;
+                texture_locked = true;
+                MoveVideoBuffer();
+                return;
+            }
+        }
+    }
+
+    SDL_UnlockTexture(texture);
+    texture_lock_failed = true;
+}
+
+// [JN] Move the frame back into a surface of its own, before the
+// texture is destroyed or can't be locked again.
+
+static void UnlockTextureBuffer (const pixel_t *frame)
+{
+    SDL_Surface *surface;
+
+    if (!texture_locked)
+    {
+        return;
+    }
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, argbbuffer->w, argbbuffer->h,
+                                             32, SDL_PIXELFORMAT_ARGB8888);
+
+    if (surface == NULL)
+    {
+        I_Error("UnlockTextureBuffer: %s", SDL_GetError());
+    }
+
+    memcpy(surface->pixels, frame,
+           argbbuffer->w * argbbuffer->h * sizeof(*frame));
+
+    SDL_FreeSurface(argbbuffer);
+    argbbuffer = surface;
+    texture_locked = false;
+    MoveVideoBuffer();
+}
+
+// -----------------------------------------------------------------------------
+// UpdateGammaLUT
+//  [JN] Rebuild the gamma tables for the current vid_gamma value. The
+//  whole frame has to be uploaded again afterwards.
+// -----------------------------------------------------------------------------
+
+static void UpdateGammaLUT (void)
+{
+    const byte *const gamma = gammatable[vid_gamma];
+
+    for (int i = 0; i < 256; i++)
+    {
+        gamma_lut[0][i] = 0xff000000 | (gamma[i] << 16);
+        gamma_lut[1][i] = gamma[i] << 8;
+        gamma_lut[2][i] = gamma[i];
+    }
+
+    gamma_level = vid_gamma;
+    V_MarkScreen();
+}
+
+// [JN] Gamma correct a rectangle of the frame, dest may be the same as src.
+
+static void ApplyGammaRows (pixel_t *dest, const pixel_t *src,
+                            int width, int height)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const pixel_t p = src[x];
+
+            dest[x] = gamma_lut[0][(p >> 16) & 0xff]
+                    | gamma_lut[1][(p >> 8) & 0xff]
+                    | gamma_lut[2][p & 0xff];
+        }
+
+        src += SCREENWIDTH;
+        dest += SCREENWIDTH;
+    }
+}
+
+// [JN] Rectangles smaller than this many pixels aren't worth splitting
+// across the worker threads.
+
+#define GAMMA_PARALLEL_AREA (64 * 1024)
+
+typedef struct
+{
+    pixel_t *dest;
+    const pixel_t *src;
+    int width;
+    int height;
+    int rows;  // rows per band
+} gammajob_t;
+
+static void GammaBandJob (int index, void *data)
+{
+    const gammajob_t *const job = (const gammajob_t *) data;
+    const int y = index * job->rows;
+    const int offset = y * SCREENWIDTH;
+
+    ApplyGammaRows(job->dest + offset, job->src + offset, job->width,
+                   MIN(job->rows, job->height - y));
+}
+
+static void ApplyGamma (pixel_t *dest, const pixel_t *src,
+                        int width, int height)
+{
+    const int threads = I_NumThreads();
+    gammajob_t job;
+
+    if (threads < 2 || width * height < GAMMA_PARALLEL_AREA)
+    {
+        ApplyGammaRows(dest, src, width, height);
+        return;
+    }
+
+    // [JN] One band of rows for each thread.
+
+    job.dest = dest;
+    job.src = src;
+    job.width = width;
+    job.height = height;
+    job.rows = (height + threads - 1) / threads;
+
+    I_ParallelFor((height + job.rows - 1) / job.rows, GammaBandJob, &job);
+}
+
+// [JN] Copy a rectangle of the frame into the texture, gamma corrected
+// if needed. NULL means the whole frame.
+
+static void UploadRect (const SDL_Rect *rect)
+{
+    const int offset = rect ? rect->y * SCREENWIDTH + rect->x : 0;
+    const pixel_t *pixels = (const pixel_t *) argbbuffer->pixels + offset;
+
+    // [JN] At GAMMAOFF the frame is uploaded as it is. gammatable[GAMMAOFF]
+    // is not an identity table, it just isn't used.
+
+    if (vid_gamma != GAMMAOFF)
+    {
+        ApplyGamma(gammabuffer + offset, pixels,
+                   rect ? rect->w : SCREENWIDTH,
+                   rect ? rect->h : SCREENHEIGHT);
+        pixels = gammabuffer + offset;
+    }
+
+    SDL_UpdateTexture(texture, rect, pixels, SCREENWIDTH * sizeof(*pixels));
+}
+
+// -----------------------------------------------------------------------------
+// LimitFrameRate
+//  [JN] Frames are started at fixed deadlines, so that the time taken to
+//  render a frame doesn't add up to the interval between them. After a
+//  long frame, e.g. when loading a level, start over instead of trying
+//  to catch up.
+// -----------------------------------------------------------------------------
+
+static uint64_t next_frame_time;
+
+static void LimitFrameRate (void)
+{
+    const uint64_t frame_time = 1000000ull / vid_fpslimit;
+    const uint64_t now = I_GetTimeUS();
+
+    if (now >= next_frame_time + frame_time)
+    {
+        next_frame_time = now + frame_time;
+        return;
+    }
+
+    I_WaitUntilUS(next_frame_time);
+    next_frame_time += frame_time;
+}
+
 //
 // I_FinishUpdate
 //
@@ -954,9 +1370,75 @@ void I_FinishUpdate (void)
 		}
 	}
 
+    // [JN] Queue the frame for -capture.
+
+    I_CaptureFrame(gametic);
+
     // Update the intermediate texture with the contents of the RGBA buffer.
+    // [JN] Or just unlock it, if the frame has been drawn right into it.
+
+    // [JN] Otherwise only upload the changed areas of the screen, unless
+    // they cover most of it anyway.
+
+    // [JN] Gamma correction needs the frame to be copied, so it can't be
+    // drawn right into the texture meanwhile. Switching between the two
+    // moves I_VideoBuffer, see MoveVideoBuffer.
 
-    SDL_UpdateTexture(texture, NULL, argbbuffer->pixels, argbbuffer->pitch);
+    if (vid_gamma != gamma_level)
+    {
+        UpdateGammaLUT();
+    }
+
+    if (texture_locked && vid_gamma != GAMMAOFF)
+    {
+        UnlockTextureBuffer(argbbuffer->pixels);
+        SDL_UnlockTexture(texture);
+    }
+
+    if (vid_gamma != GAMMAOFF && gammabuffer_area != SCREENAREA)
+    {
+        free(gammabuffer);
+        gammabuffer = malloc(SCREENAREA * sizeof(*gammabuffer));
+        gammabuffer_area = SCREENAREA;
+
+        if (gammabuffer == NULL)
+        {
+            I_Error("I_FinishUpdate: failed to allocate gamma buffer");
+        }
+    }
+
+    if (texture_locked)
+    {
+        SDL_UnlockTexture(texture);
+    }
+    else
+    {
+        const vrect_t *rects;
+        const int numrects = V_GetDirtyRects(&rects);
+        int area = 0;
+
+        for (int i = 0; i < numrects; i++)
+        {
+            area += rects[i].w * rects[i].h;
+        }
+
+        if (numrects < 0 || area > SCREENAREA / 4 * 3)
+        {
+            UploadRect(NULL);
+        }
+        else
+        {
+            for (int i = 0; i < numrects; i++)
+            {
+                const SDL_Rect rect = { rects[i].x, rects[i].y,
+                                        rects[i].w, rects[i].h };
+
+                UploadRect(&rect);
+            }
+        }
+    }
+
+    V_ClearDirtyRects();
 
     // Make sure the pillarboxes are kept clear each frame.
 
@@ -991,34 +1473,42 @@ void I_FinishUpdate (void)
 
     SDL_RenderPresent(renderer);
 
-    if (vid_uncapped_fps)
+    // [JN] Lock the texture again for drawing the next frame. The pixels
+    // are expected to stay where they are, fall back to argbbuffer if not.
+
+    if (texture_locked)
     {
-        // Limit framerate
-        if (vid_fpslimit >= TICRATE)
-        {
-            uint64_t target_time = 1000000ull / vid_fpslimit;
-            static uint64_t start_time;
+        void *pixels;
+        int pitch;
 
-            while (1)
-            {
-                uint64_t current_time = I_GetTimeUS();
-                uint64_t elapsed_time = current_time - start_time;
-                uint64_t remaining_time = 0;
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) < 0)
+        {
+            UnlockTextureBuffer(argbbuffer->pixels);
+            texture_lock_failed = true;
+        }
+        else if (pixels != argbbuffer->pixels)
+        {
+            UnlockTextureBuffer(argbbuffer->pixels);
+            SDL_UnlockTexture(texture);
+            texture_lock_failed = true;
+        }
+    }
+    else
+    {
+        // [JN] Gamma correction may have been switched off.
 
-                if (elapsed_time >= target_time)
-                {
-                    start_time = current_time;
-                    break;
-                }
+        LockTextureBuffer();
+    }
 
-                remaining_time = target_time - elapsed_time;
+    if (frame_stats)
+    {
+        RecordPresent();
+    }
 
-                if (remaining_time > 1000)
-                {
-                    I_Sleep((remaining_time - 1000) / 1000);
-                }
-            }
-        }
+    // Limit framerate
+    if (vid_uncapped_fps && vid_fpslimit >= TICRATE)
+    {
+        LimitFrameRate();
     }
 }
 
@@ -1037,36 +1527,23 @@ void I_ReadScreen (pixel_t* scr)
 //
 void I_SetPalette (int palette)
 {
-    switch (palette)
-    {
-		case 0:		curpane = NULL;			break;
-		// Red palette
-		case 1:		curpane = palette_01;	break;
-		case 2:		curpane = palette_02;	break;
-		case 3:		curpane = palette_03;	break;
-		case 4:		curpane = palette_04;	break;
-		case 5:		curpane = palette_05;	break;
-		case 6:		curpane = palette_06;	break;
-		case 7:		curpane = palette_07;	break;
-		case 8:		curpane = palette_08;	break;
-		case 9:		curpane = palette_09;	break;
-		case 10:	curpane = palette_10;	break;
-		case 11:	curpane = palette_11;	break;
-		case 12:	curpane = palette_12;	break;
-		case 13:	curpane = palette_13;	break;
-		case 14:	curpane = palette_14;	break;
-		case 15:	curpane = palette_15;	break;
-		case 16:	curpane = palette_16;	break;
-		// Yellow palette
-		case 17:	curpane = palette_17;	pane_alpha = yel_pane_alpha;	break;
-		// Green palette
-		case 18:	curpane = palette_18;	pane_alpha = 140;   break;
-		// Yellow + green (bonus+rad)
-		case 19:	curpane = palette_19;	break;
-
-		default:
-			I_Error("Unknown palette: %d!\n", palette);
-			break;
+    if (palette < 0 || palette >= NUMPANES)
+    {
+        I_Error("Unknown palette: %d!\n", palette);
+    }
+
+    curpane = panes[palette];
+    curpane_index = palette;
+
+    // Yellow palette
+    if (palette == 17)
+    {
+        pane_alpha = yel_pane_alpha;
+    }
+    // Green palette
+    else if (palette == 18)
+    {
+        pane_alpha = 140;
     }
 }
 
@@ -1331,11 +1808,16 @@ void CenterWindow(int *x, int *y, int w, int h)
 }
 
 // [PN] Helper function to reduce code duplication and create a texture for a given RGB color and blend mode.
-static SDL_Texture *CreatePaletteTexture (uint8_t r, uint8_t g, uint8_t b, SDL_BlendMode blendMode)
+static SDL_Texture *CreatePaletteTexture (const pane_t *pane)
 {
-    SDL_FillRect(argbbuffer, NULL, I_MapRGB(r, g, b));
+    static const SDL_BlendMode blend_modes[] = {
+        SDL_BLENDMODE_NONE, SDL_BLENDMODE_MOD,
+        SDL_BLENDMODE_BLEND, SDL_BLENDMODE_MUL
+    };
+
+    SDL_FillRect(argbbuffer, NULL, I_MapRGB(pane->r, pane->g, pane->b));
     SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, argbbuffer);
-    SDL_SetTextureBlendMode(texture, blendMode);
+    SDL_SetTextureBlendMode(texture, blend_modes[pane->mode]);
     return texture;
 }
 
@@ -1517,25 +1999,10 @@ static void SetVideoMode(void)
                      0, SCREENWIDTH, SCREENHEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
 
         // [PN] Use the helper function to create textures for all palettes
-        palette_01 = CreatePaletteTexture(255, 240, 240, SDL_BLENDMODE_MOD);   // Red palettes
-        palette_02 = CreatePaletteTexture(255, 225, 225, SDL_BLENDMODE_MOD);
-        palette_03 = CreatePaletteTexture(255, 210, 210, SDL_BLENDMODE_MOD);
-        palette_04 = CreatePaletteTexture(255, 195, 195, SDL_BLENDMODE_MOD);
-        palette_05 = CreatePaletteTexture(255, 180, 180, SDL_BLENDMODE_MOD);
-        palette_06 = CreatePaletteTexture(255, 165, 165, SDL_BLENDMODE_MOD);
-        palette_07 = CreatePaletteTexture(255, 150, 150, SDL_BLENDMODE_MOD);
-        palette_08 = CreatePaletteTexture(255, 135, 135, SDL_BLENDMODE_MOD);
-        palette_09 = CreatePaletteTexture(255, 120, 120, SDL_BLENDMODE_MOD);
-        palette_10 = CreatePaletteTexture(255, 105, 105, SDL_BLENDMODE_MOD);
-        palette_11 = CreatePaletteTexture(255,  90,  90, SDL_BLENDMODE_MOD);
-        palette_12 = CreatePaletteTexture(255,  75,  75, SDL_BLENDMODE_MOD);
-        palette_13 = CreatePaletteTexture(255,  60,  60, SDL_BLENDMODE_MOD);
-        palette_14 = CreatePaletteTexture(255,  45,  45, SDL_BLENDMODE_MOD);
-        palette_15 = CreatePaletteTexture(255,  30,  30, SDL_BLENDMODE_MOD);
-        palette_16 = CreatePaletteTexture(255,  15,  15, SDL_BLENDMODE_MOD);
-        palette_17 = CreatePaletteTexture(255, 164,   0, SDL_BLENDMODE_BLEND); // Yellow palette
-        palette_18 = CreatePaletteTexture( 64, 255,   0, SDL_BLENDMODE_MUL);   // Green palette
-        palette_19 = CreatePaletteTexture(191, 255,   0, SDL_BLENDMODE_MUL);   // Yellow + Green palette
+        for (int i = 1; i < NUMPANES; i++)
+        {
+            panes[i] = CreatePaletteTexture(&pane_colors[i]);
+        }
 
         SDL_FillRect(argbbuffer, NULL, 0);
     }
@@ -1569,6 +2036,10 @@ static void SetVideoMode(void)
 
     CreateUpscaledTexture(true);
 
+    // [JN] Draw right into the texture, if possible.
+
+    LockTextureBuffer();
+
     // [JN] Set the initial position of the mouse cursor.
     {
         int screen_w, screen_h;
@@ -1748,12 +2219,38 @@ void I_InitGraphics(void)
     while (SDL_PollEvent(&dummy));
 
     initialized = true;
+
+    // [JN] Start -capture, now that the rendering resolution is known.
+    I_InitCapture();
+
+    //!
+    // @category video
+    //
+    // Count the intervals between presented frames and the time from
+    // reading the mouse to presenting a frame, and print them at exit.
+    //
+
+    if (M_ParmExists("-framestats"))
+    {
+        frame_stats = true;
+        I_AtExit(PrintFrameStats, true);
+    }
 }
 
 // [crispy] re-initialize only the parts of the rendering stack that are really necessary
 
 void I_ReInitGraphics (int reinit)
 {
+	// [JN] The texture may be destroyed, take the frame out of it.
+	if (texture_locked)
+	{
+		UnlockTextureBuffer(argbbuffer->pixels);
+		SDL_UnlockTexture(texture);
+	}
+
+	// [JN] Upload the whole frame to the new texture.
+	V_MarkScreen();
+
 	// [crispy] re-set rendering resolution and re-create framebuffers
 	if (reinit & REINIT_FRAMEBUFFERS)
 	{
@@ -1844,72 +2341,36 @@ void I_ReInitGraphics (int reinit)
 		#endif
 	}
 
+	// [JN] Draw right into the texture again.
+	LockTextureBuffer();
+
 	// [crispy] adjust the window size and re-set the palette
 	need_resize = true;
 }
 
-// [crispy] take screenshot of the rendered image
+// [JN] Copy the rendered frame for a screenshot. This is cheap enough
+// to do on the game thread, unlike reading back the rendered output.
 
-void I_RenderReadPixels (byte **data, int *w, int *h)
+void I_ReadScreenFrame (pixel_t *dest, pane_t *pane, int *height)
 {
-	SDL_Rect rect;
-	SDL_PixelFormat *format;
-	int temp;
-	uint32_t png_format;
-	byte *pixels;
-
-    // [crispy] adjust cropping rectangle if necessary
-    rect.x = rect.y = 0;
-    SDL_GetRendererOutputSize(renderer, &rect.w, &rect.h);
-    if (vid_aspect_ratio_correct)
+    memcpy(dest, argbbuffer->pixels, SCREENAREA * sizeof(*dest));
+
+    // [JN] Screenshots are taken as seen, with gamma correction.
+
+    if (vid_gamma != GAMMAOFF)
     {
-        if (rect.w * actualheight > rect.h * SCREENWIDTH)
+        if (vid_gamma != gamma_level)
         {
-            temp = rect.w;
-            rect.w = rect.h * SCREENWIDTH / actualheight;
-            rect.x = (temp - rect.w) / 2;
+            UpdateGammaLUT();
         }
-        else
-        if (rect.h * SCREENWIDTH > rect.w * actualheight)
-        {
-            temp = rect.h;
-            rect.h = rect.w * actualheight / SCREENWIDTH;
-            rect.y = (temp - rect.h) / 2;
-        }
-    }
-
-    // [crispy] native PNG pixel format
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-    png_format = SDL_PIXELFORMAT_ABGR8888;
-#else
-    png_format = SDL_PIXELFORMAT_RGBA8888;
-#endif
-    format = SDL_AllocFormat(png_format);
-    temp = rect.w * format->BytesPerPixel; // [crispy] pitch
 
-    // [crispy] As far as I understand the issue, SDL_RenderPresent()
-    // may return early, i.e. before it has actually finished rendering the
-    // current texture to screen -- from where we want to capture it.
-    // However, it does never return before it has finished rendering the
-    // *previous* texture.
-    // Thus, we add a second call to SDL_RenderPresent() here to make sure
-    // that it has at least finished rendering the previous texture, which
-    // already contains the scene that we actually want to capture.
-    if (post_rendering_hook)
-    {
-        SDL_RenderCopy(renderer, vid_smooth_scaling ? texture_upscaled : texture, NULL, NULL);
-        SDL_RenderPresent(renderer);
+        ApplyGamma(dest, dest, SCREENWIDTH, SCREENHEIGHT);
     }
 
-    // [crispy] allocate memory for screenshot image
-    pixels = malloc(rect.h * temp);
-    SDL_RenderReadPixels(renderer, &rect, format->format, pixels, temp);
-
-    *data = pixels;
-    *w = rect.w;
-    *h = rect.h;
+    *pane = pane_colors[curpane_index];
+    pane->a = pane_alpha;
 
-    SDL_FreeFormat(format);
+    *height = vid_aspect_ratio_correct ? actualheight : SCREENHEIGHT;
 }
 
 // Bind all variables controlling video options into the configuration
@@ -1927,6 +2388,7 @@ void I_BindVideoVariables(void)
     M_BindIntVariable("vid_fullscreen_width",          &vid_fullscreen_width);
     M_BindIntVariable("vid_fullscreen_height",         &vid_fullscreen_height);
     M_BindIntVariable("vid_force_software_renderer",   &vid_force_software_renderer);
+    M_BindIntVariable("vid_lock_texture",              &vid_lock_texture);
     M_BindIntVariable("vid_max_scaling_buffer_pixels", &vid_max_scaling_buffer_pixels);
     M_BindIntVariable("vid_window_width",              &vid_window_width);
     M_BindIntVariable("vid_window_height",             &vid_window_height);
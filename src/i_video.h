@@ -79,6 +79,7 @@ void *I_GetSDLWindow(void);
 void *I_GetSDLRenderer(void);
 
 typedef boolean (*grabmouse_callback_t)(void);
+typedef void (*videobuffer_callback_t)(void);
 
 // Called by D_DoomMain,
 // determines the hardware configuration
@@ -90,7 +91,28 @@ void I_GraphicsCheckCommandLine(void);
 
 void I_ShutdownGraphics(void);
 
-void I_RenderReadPixels (byte **data, int *w, int *h);
+// [JN] Palette panes drawn over the frame, and how they are blended.
+
+#define NUMPANES 20
+
+typedef enum
+{
+    PANE_NONE,
+    PANE_MOD,       // color * pane
+    PANE_BLEND,     // pane * alpha + color * (1 - alpha)
+    PANE_MUL,       // color * pane + color * (1 - alpha)
+} panemode_t;
+
+typedef struct
+{
+    panemode_t mode;
+    byte r, g, b, a;
+} pane_t;
+
+// Copy the rendered frame, SCREENWIDTH x SCREENHEIGHT pixels, for a
+// screenshot. Returns the pane drawn over it and the height the frame
+// is shown at, which differs with aspect ratio correction.
+void I_ReadScreenFrame (pixel_t *dest, pane_t *pane, int *height);
 
 // Takes full 8 bit values.
 void I_SetPalette (int palette);
@@ -121,6 +143,7 @@ void I_SetWindowTitle(const char *title);
 
 void I_CheckIsScreensaver(void);
 void I_SetGrabMouseCallback(grabmouse_callback_t func);
+void I_SetVideoBufferCallback(videobuffer_callback_t func);
 void CenterWindow(int *x, int *y, int w, int h);
 
 void I_BindVideoVariables(void);
@@ -39,6 +39,7 @@ int vid_widescreen = 0;
 int vid_uncapped_fps = 0;
 int vid_fpslimit = 0;
 int vid_vsync = 1;
+int vid_late_input = 0;
 int vid_showfps = 0;
 int vid_smooth_scaling = 0;
 int vid_screenwipe = 1;
@@ -175,6 +176,7 @@ void ID_BindVariables (void)
     M_BindIntVariable("vid_uncapped_fps",               &vid_uncapped_fps);
     M_BindIntVariable("vid_fpslimit",                   &vid_fpslimit);
     M_BindIntVariable("vid_vsync",                      &vid_vsync);
+    M_BindIntVariable("vid_late_input",                 &vid_late_input);
     M_BindIntVariable("vid_showfps",                    &vid_showfps);
     M_BindIntVariable("vid_smooth_scaling",             &vid_smooth_scaling);
     M_BindIntVariable("vid_screenwipe",                 &vid_screenwipe);
@@ -30,6 +30,7 @@ extern int vid_widescreen;
 extern int vid_uncapped_fps;
 extern int vid_fpslimit;
 extern int vid_vsync;
+extern int vid_late_input;
 extern int vid_showfps;
 extern int vid_gamma;
 extern int vid_fov;
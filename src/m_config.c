@@ -169,6 +169,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(vid_fullscreen_width),
     CONFIG_VARIABLE_INT(vid_fullscreen_height),
     CONFIG_VARIABLE_INT(vid_force_software_renderer),
+    CONFIG_VARIABLE_INT(vid_lock_texture),
     CONFIG_VARIABLE_INT(vid_max_scaling_buffer_pixels),
     CONFIG_VARIABLE_COMMENT(""),
 
@@ -179,6 +180,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(vid_uncapped_fps),
     CONFIG_VARIABLE_INT(vid_fpslimit),
     CONFIG_VARIABLE_INT(vid_vsync),
+    CONFIG_VARIABLE_INT(vid_late_input),
     CONFIG_VARIABLE_INT(vid_showfps),
     CONFIG_VARIABLE_INT(vid_smooth_scaling),
     CONFIG_VARIABLE_INT(vid_screenwipe),
@@ -262,6 +264,7 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(snd_samplerate),
     CONFIG_VARIABLE_INT(snd_cachesize),
     CONFIG_VARIABLE_INT(snd_maxslicetime_ms),
+    CONFIG_VARIABLE_INT(snd_nativemixer),
     CONFIG_VARIABLE_COMMENT(""),
 
     //
@@ -58,6 +58,7 @@ extern const fixed_t finetangent[FINEANGLES/2];
 
 // Gamma correction tables.
 #define MAXGAMMA  41
+#define GAMMAOFF  10  // [JN] Level without correction, see I_FinishUpdate
 extern const byte gammatable[MAXGAMMA][256];
 
 // Binary Angle Measument, BAM.
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include "m_random.h"
 #include "v_postproc.h"
+#include "v_video.h"
 
 
 // -----------------------------------------------------------------------------
@@ -998,6 +999,10 @@ void V_PProc_Display (boolean supress)
     pproc_display_effects =
         post_overglow || post_rgbdrift || post_vhsdist;
     
+    // [JN] Effects are applied right to the screen buffer.
+    if (pproc_display_effects)
+        V_MarkScreen();
+
     // Overbright Glow
     if (post_overglow && !supress)
         V_PProc_OverbrightGlow();
@@ -1016,6 +1021,9 @@ void V_PProc_PlayerView (void)
     pproc_plyrview_effects =
         post_bloom || post_filmgrain || post_motionblur || post_dofblur || post_vignette;
 
+    if (pproc_plyrview_effects)
+        V_MarkScreen();
+
     // Soft bloom
     if (post_bloom)
         V_PProc_BloomGlow();
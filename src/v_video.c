@@ -16,20 +16,17 @@
 // GNU General Public License for more details.
 //
 
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
-#define MINIZ_NO_STDIO
-#define MINIZ_NO_ZLIB_APIS
-#include "miniz.h"
-
 #include "doomtype.h"
 #include "i_input.h"
+#include "i_shot.h"
 #include "i_swap.h"
 #include "i_system.h"
 #include "i_video.h"
-#include "m_bbox.h"
 #include "m_config.h"
 #include "m_misc.h"
 #include "v_video.h"
@@ -57,24 +54,140 @@ static pixel_t *dest_screen = NULL;
 static fixed_t dx, dxi, dy, dyi;
 
 
+// [JN] Areas of the screen buffer changed since the last update, in
+// screen pixels. I_FinishUpdate only uploads these to the texture.
+#define MAXDIRTYRECTS 32
+
+static vrect_t dirtyrects[MAXDIRTYRECTS];
+static int numdirtyrects;
+static boolean dirtyscreen = true;
+
+
+// -----------------------------------------------------------------------------
+// MarkScreenRect
+//  [JN] Add a rectangle to the dirty list. It's merged with the rectangle
+//  that grows the least from it, if that doesn't add any area to be
+//  uploaded, or if the list is full.
+// -----------------------------------------------------------------------------
+
+static void MarkScreenRect (int x, int y, int width, int height)
+{
+    int x2 = x + width;
+    int y2 = y + height;
+    int best = -1;
+    int best_waste = INT_MAX;
+
+    if (dirtyscreen)
+    {
+        return;
+    }
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x2 > SCREENWIDTH) x2 = SCREENWIDTH;
+    if (y2 > SCREENHEIGHT) y2 = SCREENHEIGHT;
+
+    if (x >= x2 || y >= y2)
+    {
+        return;
+    }
+
+    for (int i = 0; i < numdirtyrects; i++)
+    {
+        const vrect_t *r = &dirtyrects[i];
+        const int ux = MIN(x, r->x);
+        const int uy = MIN(y, r->y);
+        const int uw = MAX(x2, r->x + r->w) - ux;
+        const int uh = MAX(y2, r->y + r->h) - uy;
+        const int waste = uw * uh - r->w * r->h - (x2 - x) * (y2 - y);
+
+        if (waste < best_waste)
+        {
+            best = i;
+            best_waste = waste;
+        }
+    }
+
+    if (best >= 0 && (best_waste <= 0 || numdirtyrects == MAXDIRTYRECTS))
+    {
+        vrect_t *r = &dirtyrects[best];
+
+        x2 = MAX(x2, r->x + r->w);
+        y2 = MAX(y2, r->y + r->h);
+        r->x = MIN(x, r->x);
+        r->y = MIN(y, r->y);
+        r->w = x2 - r->x;
+        r->h = y2 - r->y;
+    }
+    else
+    {
+        dirtyrects[numdirtyrects].x = x;
+        dirtyrects[numdirtyrects].y = y;
+        dirtyrects[numdirtyrects].w = x2 - x;
+        dirtyrects[numdirtyrects].h = y2 - y;
+        numdirtyrects++;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // V_MarkRect
+//  [JN] Mark an area of the screen as changed, in screen pixels.
 // -----------------------------------------------------------------------------
 
 void V_MarkRect(int x, int y, int width, int height) 
 {
-    static int dirtybox[4];
-
     // If we are temporarily using an alternate screen, do not
     // affect the update box.
 
     if (dest_screen == I_VideoBuffer)
     {
-        M_AddToBox (dirtybox, x, y);
-        M_AddToBox (dirtybox, x + width-1, y + height-1);
+        MarkScreenRect(x, y, width, height);
     }
 }
 
+// [JN] Mark the area of a patch, in original resolution coordinates.
+// The scaled edges are rounded outwards.
+
+static void V_MarkPatch (int x, int y, int width, int height)
+{
+    const int x1 = (x * dx) >> FRACBITS;
+    const int y1 = (y * dy) >> FRACBITS;
+    const int x2 = ((x + width) * dx) >> FRACBITS;
+    const int y2 = ((y + height) * dy) >> FRACBITS;
+
+    V_MarkRect(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+}
+
+// -----------------------------------------------------------------------------
+// V_MarkScreen
+//  [JN] Mark the whole screen as changed, for code writing to the screen
+//  buffer without going through the V_Draw* functions.
+// -----------------------------------------------------------------------------
+
+void V_MarkScreen (void)
+{
+    dirtyscreen = true;
+}
+
+// -----------------------------------------------------------------------------
+// V_GetDirtyRects
+//  [JN] Returns the number of changed rectangles, or -1 if the whole
+//  screen has to be updated. V_ClearDirtyRects starts a new list.
+// -----------------------------------------------------------------------------
+
+int V_GetDirtyRects (const vrect_t **rects)
+{
+    *rects = dirtyrects;
+
+    return dirtyscreen ? -1 : numdirtyrects;
+}
+
+void V_ClearDirtyRects (void)
+{
+    dirtyscreen = false;
+    numdirtyrects = 0;
+}
+
 // -----------------------------------------------------------------------------
 // V_CopyRect
 // -----------------------------------------------------------------------------
@@ -205,8 +318,8 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     x -= SHORT(patch->leftoffset);
     x += ws_delta; // horizontal widescreen offset
 
-    // Mark dirty rectangle (original semantics).
-    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+    // Mark dirty rectangle.
+    V_MarkPatch(x, y, SHORT(patch->width), SHORT(patch->height));
 
     // Left clipping in fixed-point column space.
     col = 0;
@@ -376,8 +489,8 @@ void V_DrawShadowedPatchOptional(int x, int y, patch_t *patch)
     x -= SHORT(patch->leftoffset);
     x += ws_delta; // horizontal widescreen offset
 
-    // Mark dirty rectangle (original semantics).
-    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+    // Mark dirty rectangle, with the shadow.
+    V_MarkPatch(x, y, SHORT(patch->width) + 1, SHORT(patch->height) + 1);
 
     // Left clipping in fixed-point column space.
     col = 0;
@@ -538,12 +651,13 @@ void V_DrawShadowedPatchOptional(int x, int y, patch_t *patch)
 
 void V_DrawPatchFullScreen(patch_t *patch, boolean flipped)
 {
+    // [JN] Cancel the patch offsets here instead of clearing them in the
+    // cached lump, which may be a read-only mapping of the WAD.
     const int x = DivRoundClosest((ORIGWIDTH - SHORT(patch->width)), 2);
+    const int left = x + SHORT(patch->leftoffset);
+    const int top = SHORT(patch->topoffset);
     static int black = -1;
 
-    patch->leftoffset = 0;
-    patch->topoffset = 0;
-
     if (black == -1)
     {
         black = I_MapRGB(0x00, 0x00, 0x00);
@@ -557,11 +671,11 @@ void V_DrawPatchFullScreen(patch_t *patch, boolean flipped)
 
     if (flipped)
     {
-        V_DrawPatchFlipped(x, 0, patch);
+        V_DrawPatchFlipped(left, top, patch);
     }
     else
     {
-        V_DrawPatch(x, 0, patch);
+        V_DrawPatch(left, top, patch);
     }
 }
 
@@ -598,8 +712,8 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
     x -= SHORT(patch->leftoffset);
     x += ws_delta; // horizontal widescreen offset
 
-    // Mark dirty rectangle (original semantics).
-    V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+    // Mark dirty rectangle.
+    V_MarkPatch(x, y, SHORT(patch->width), SHORT(patch->height));
 
     // Left clipping in fixed-point column space.
     col = 0;
@@ -714,7 +828,7 @@ void V_DrawPatchFinale (int x, int y, patch_t *patch)
 	x -= SHORT(patch->leftoffset);
 	x += (WIDESCREENDELTA/2);
 
-	V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
+	V_MarkRect(x * m, y * m, SHORT(patch->width) * m, SHORT(patch->height) * m);
 
 	col = 0;
 	desttop = dest_screen  + (y * m) * SCREENWIDTH + x;
@@ -789,6 +903,8 @@ void V_DrawFadePatch (int x, int y, const patch_t *restrict patch, int alpha)
     if (x < 0 || x + pw > vw || y < 0 || y + ph > vh)
         return;
 
+    V_MarkPatch(x, y, pw, ph);
+
     // Precompute column start on destination
     pixel_t *restrict desttop =
         dst + ((y * ldy) >> FRACBITS) * sw + ((x * ldx) >> FRACBITS);
@@ -890,7 +1006,7 @@ void V_DrawBlock(int x, int y, int width, int height, pixel_t *src)
     if (width <= 0 || height <= 0 || src == NULL)
         return;
 
-    V_MarkRect(x, y, width, height);
+    V_MarkRect(x, y * vres, width, height);
 
     // Compute destination start once. Note: y is scaled by vid_resolution.
     pixel_t *restrict dest = dst_screen_local + (y * vres) * sw + x;
@@ -950,6 +1066,8 @@ void V_DrawScaledBlock(int x, int y, int width, int height, byte *src)
     if (dw <= 0 || dh <= 0)
         return;
 
+    V_MarkRect(dx0, dy0, dw, dh);
+
     // Offsets of the clipped block relative to the un-clipped scaled origin
     const int xoff = dx0 - rx;  // 0..vres-1
     const int yoff = dy0 - ry;  // 0..vres-1
@@ -1023,7 +1141,7 @@ void V_DrawFilledBox(int x, int y, int w, int h, int c)
     if (w <= 0 || h <= 0)
         return;
 
-    V_MarkRect(x, y, w, h);
+    MarkScreenRect(x, y, w, h);
 
     pixel_t *restrict row0 = screen + y * sw + x;
     const pixel_t color = (pixel_t)c;
@@ -1068,6 +1186,8 @@ void V_DrawHorizLine(int x, int y, int w, int c)
     if (x + w > (unsigned)SCREENWIDTH)
 	w = SCREENWIDTH - x;
 
+    MarkScreenRect(x, y, w, 1);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (x1 = 0; x1 < w; ++x1)
@@ -1081,6 +1201,8 @@ void V_DrawVertLine(int x, int y, int h, int c)
     pixel_t *buf;
     int y1;
 
+    MarkScreenRect(x, y, 1, h);
+
     buf = I_VideoBuffer + SCREENWIDTH * y + x;
 
     for (y1 = 0; y1 < h; ++y1)
@@ -1119,6 +1241,16 @@ void V_FillFlat(int y_start, int y_stop, int x_start, int x_stop,
 
     pixel_t *restrict d = dest;
 
+    // [JN] The rows are written one after another from dest, so mark
+    // the whole lines of the screen that they cover.
+    if (dest >= I_VideoBuffer && dest < I_VideoBuffer + SCREENAREA)
+    {
+        const int ofs = dest - I_VideoBuffer;
+
+        MarkScreenRect(0, ofs / SCREENWIDTH, SCREENWIDTH,
+                       (ofs % SCREENWIDTH + dw * dh + SCREENWIDTH - 1) / SCREENWIDTH);
+    }
+
     // Initial source Y index and accumulator (no per-row division)
     int src_y = (vres > 1) ? ((y_start / vres) & 63) : (y_start & 63);
     int hy    = (vres > 1) ?  (y_start % vres)       : 0;
@@ -1187,49 +1319,29 @@ void V_RestoreBuffer(void)
 //
 
 
-//
-// WritePNGfile
-//
-
-static void WritePNGfile (const char *filename)
-{
-    byte *data;
-    int width, height;
-    size_t png_data_size = 0;
-
-    I_RenderReadPixels(&data, &width, &height);
-    {
-        void *pPNG_data = tdefl_write_image_to_png_file_in_memory(data, width, height, 4, &png_data_size);
-
-        if (!pPNG_data)
-        {
-            return;
-        }
-        else
-        {
-            FILE *handle = M_fopen(filename, "wb");
-            fwrite(pPNG_data, 1, png_data_size, handle);
-            fclose(handle);
-            mz_free(pPNG_data);
-        }
-    }
-
-    free(data);
-}
-
 //
 // V_ScreenShot
 //
 
 void V_ScreenShot(const char *format)
 {
+    // [JN] Start looking for a file name after the last screenshot, the
+    // files of earlier ones may still be being written.
+    static const char *last_format = NULL;
+    static int next_index = 0;
     int i;
     char lbmname[16]; // haleyjd 20110213: BUG FIX - 12 is too small!
-    char *file;
-    
+    char *file = NULL;
+
+    if (format != last_format)
+    {
+        last_format = format;
+        next_index = 0;
+    }
+
     // find a file name to save it to
 
-    for (i=0; i<=9999; i++)
+    for (i=next_index; i<=9999; i++)
     {
         M_snprintf(lbmname, sizeof(lbmname), format, i, "png");
         // [JN] Construct full path to screenshot file.
@@ -1247,7 +1359,9 @@ void V_ScreenShot(const char *format)
         I_Error ("V_ScreenShot: Couldn't create a PNG");
     }
 
-    WritePNGfile(file);
+    next_index = i + 1;
+
+    I_SaveScreenShot(file);
 	free(file);
 }
 
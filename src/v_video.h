@@ -31,7 +31,16 @@ extern boolean V_IsPatchLump(const int lump);
 extern boolean dp_translucent;
 extern pixel_t *palette_pointer;
 
+// [JN] Changed area of the screen, in screen pixels.
+typedef struct
+{
+    int x, y, w, h;
+} vrect_t;
+
 void V_MarkRect(int x, int y, int width, int height);
+void V_MarkScreen (void);
+int V_GetDirtyRects (const vrect_t **rects);
+void V_ClearDirtyRects (void);
 void V_CopyRect(int srcx, int srcy, pixel_t *source, int width, int height, int destx, int desty);
 void V_DrawPatch(int x, int y, patch_t *patch);
 void V_DrawShadowedPatchOptional(int x, int y, patch_t *patch);
@@ -40,9 +40,6 @@ static wad_file_class_t *wad_file_classes[] =
 
 wad_file_t *W_OpenFile(const char *path)
 {
-    wad_file_t *result;
-    int i;
-
     //!
     // @category obscure
     //
@@ -55,6 +52,14 @@ wad_file_t *W_OpenFile(const char *path)
         return stdc_wad_file.OpenFile(path);
     }
 
+    return W_OpenMappedFile(path);
+}
+
+wad_file_t *W_OpenMappedFile(const char *path)
+{
+    wad_file_t *result;
+    int i;
+
     // Try all classes in order until we find one that works
 
     result = NULL;
@@ -83,3 +88,11 @@ size_t W_Read(wad_file_t *wad, unsigned int offset,
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
 
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t length)
+{
+    if (wad->file_class->Prefetch != NULL)
+    {
+        wad->file_class->Prefetch(wad, offset, length);
+    }
+}
+
@@ -38,6 +38,11 @@ typedef struct
     // provided buffer.  Returns the number of bytes read.
     size_t (*Read)(wad_file_t *file, unsigned int offset,
                    void *buffer, size_t buffer_len);
+
+    // [JN] Optional: start reading the given range in the background,
+    // as it is going to be used soon.
+    void (*Prefetch)(wad_file_t *file, unsigned int offset,
+                     size_t length);
 } wad_file_class_t;
 
 
@@ -73,6 +78,11 @@ struct _wad_file_s
 
 wad_file_t *W_OpenFile(const char *path);
 
+// [JN] Same as W_OpenFile, but memory-maps the file whenever the
+// platform supports it, even without -mmap.
+
+wad_file_t *W_OpenMappedFile(const char *path);
+
 // Close the specified WAD file.
 
 void W_CloseFile(wad_file_t *wad);
@@ -84,4 +94,8 @@ void W_CloseFile(wad_file_t *wad);
 size_t W_Read(wad_file_t *wad, unsigned int offset,
               void *buffer, size_t buffer_len);
 
+// [JN] Hint that the given range of the file is going to be read soon.
+
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t length);
+
 #endif /* #ifndef __W_FILE__ */
@@ -23,6 +23,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <string.h>
@@ -44,12 +45,10 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
     int protection;
     int flags;
 
-    // Mapped area can be read and written to.  Ideally
-    // this should be read-only, as none of the Doom code should 
-    // change the WAD files after being read.  However, there may
-    // be code lurking in the source that does.
+    // [JN] Mapped area is read-only, none of the Doom code should
+    // change the WAD files after being read.
 
-    protection = PROT_READ|PROT_WRITE;
+    protection = PROT_READ;
 
     // Writes to the mapped area result in private changes that are
     // *not* written to disk.
@@ -68,6 +67,14 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
     else
     {
         wad->wad.mapped = result;
+
+        // [JN] Where supported, ask for huge pages to keep the TLB
+        // pressure of large WADs down. Level data is prefetched
+        // explicitly, see W_POSIX_Prefetch.
+
+#ifdef MADV_HUGEPAGE
+        madvise(result, wad->wad.length, MADV_HUGEPAGE);
+#endif
     }
 }
 
@@ -165,11 +172,40 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
 }
 
 
+// [JN] Let the kernel read the given range in the background, either
+// into the mapping or into the page cache.
+
+static void W_POSIX_Prefetch(wad_file_t *wad, unsigned int offset,
+                             size_t length)
+{
+    posix_wad_file_t *posix_wad;
+
+    posix_wad = (posix_wad_file_t *) wad;
+
+    if (posix_wad->wad.mapped != NULL)
+    {
+#ifdef MADV_WILLNEED
+        const uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+        const uintptr_t start = (uintptr_t) (posix_wad->wad.mapped + offset);
+        const uintptr_t aligned = start & ~(page - 1);
+
+        madvise((void *) aligned, length + (start - aligned), MADV_WILLNEED);
+#endif
+    }
+    else
+    {
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(posix_wad->handle, offset, length, POSIX_FADV_WILLNEED);
+#endif
+    }
+}
+
 wad_file_class_t posix_wad_file = 
 {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Prefetch,
 };
 
 
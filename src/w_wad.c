@@ -34,6 +34,7 @@
 #include "z_zone.h"
 
 #include "w_wad.h"
+#include "w_zip.h"
 
 //
 // GLOBALS
@@ -46,6 +47,19 @@ unsigned int numlumps = 0;
 // Hash table for fast lookups
 static lumpindex_t *lumphash;
 
+// [JN] Decompressed zip lumps stay in the zone as PU_CACHE blocks once
+// released, but their total size is bounded so that a compressed
+// resource pack doesn't fill the zone with old lumps.
+#define ZIP_CACHE_LIMIT (16 * 1024 * 1024)
+
+static lumpinfo_t *zip_cache_head;
+static lumpinfo_t *zip_cache_tail;
+static int zip_cache_size;
+
+// [JN] Bumped whenever the lump directory changes, so that lump
+// handles know they have to be resolved again.
+static unsigned int lump_generation = 1;
+
 static char **wad_filenames;
 
 static void AddWADFileName(const char *filename)
@@ -103,9 +117,19 @@ wad_file_t *W_AddFile (const char *filename)
     filelump_t *filerover;
     lumpinfo_t *filelumps;
     int numfilelumps;
+    ziplump_t *ziplumps = NULL;
 
     // Open the file and add to directory
-    wad_file = W_OpenFile(filename);
+    // [JN] Zip archives are memory-mapped whenever possible, so that
+    // their stored lumps can be used without copying.
+    if (W_IsZipFile(filename))
+    {
+        wad_file = W_OpenMappedFile(filename);
+    }
+    else
+    {
+        wad_file = W_OpenFile(filename);
+    }
 
     if (wad_file == NULL)
     {
@@ -113,7 +137,22 @@ wad_file_t *W_AddFile (const char *filename)
 	return NULL;
     }
 
-    if (strcasecmp(filename+strlen(filename)-3 , "wad" ) )
+    if (W_IsZipFile(filename))
+    {
+        // [JN] Zip archive, index its central directory.
+
+        numfilelumps = W_ReadZipDirectory(wad_file, &ziplumps);
+
+        if (numfilelumps <= 0)
+        {
+            W_CloseFile(wad_file);
+            I_Error("Zip file %s can not be read or has no lumps\n",
+                    filename);
+        }
+
+        fileinfo = NULL;
+    }
+    else if (strcasecmp(filename+strlen(filename)-3 , "wad" ) )
     {
 	// single lump file
 
@@ -177,16 +216,28 @@ wad_file_t *W_AddFile (const char *filename)
     {
         lumpinfo_t *lump_p = &filelumps[i - startlump];
         lump_p->wad_file = wad_file;
+        lump_p->cache = NULL;
+        lumpinfo[i] = lump_p;
+
+        if (ziplumps != NULL)
+        {
+            const ziplump_t *ziplump = &ziplumps[i - startlump];
+
+            lump_p->position = ziplump->filepos;
+            lump_p->size = ziplump->size;
+            lump_p->compressed = ziplump->compressed;
+            strncpy(lump_p->name, ziplump->name, 8);
+            continue;
+        }
+
         lump_p->position = LONG(filerover->filepos);
         lump_p->size = LONG(filerover->size);
-        lump_p->cache = NULL;
         strncpy(lump_p->name, filerover->name, 8);
-        lumpinfo[i] = lump_p;
 
         ++filerover;
     }
 
-    Z_Free(fileinfo);
+    Z_Free(ziplumps != NULL ? (void *) ziplumps : (void *) fileinfo);
 
     if (lumphash != NULL)
     {
@@ -194,6 +245,8 @@ wad_file_t *W_AddFile (const char *filename)
         lumphash = NULL;
     }
 
+    ++lump_generation;
+
     AddWADFileName(filename);
 
     return wad_file;
@@ -397,6 +450,17 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 
     l = lumpinfo[lump];
 
+    // [JN] Deflated lump from a zip archive.
+    if (l->compressed > 0)
+    {
+        if (!W_InflateLump(l->wad_file, l->position, l->compressed,
+                           dest, l->size))
+        {
+            I_Error("W_ReadLump: failed to decompress lump %i", lump);
+        }
+        return;
+    }
+
     c = W_Read(l->wad_file, l->position, dest, l->size);
 
     if (c < l->size)
@@ -409,6 +473,96 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 
 
 
+// -----------------------------------------------------------------------------
+// W_PrefetchLumpNum
+// [JN] Start reading a lump in the background, ahead of W_CacheLumpNum.
+// -----------------------------------------------------------------------------
+
+void W_PrefetchLumpNum(lumpindex_t lumpnum)
+{
+    const lumpinfo_t *lump;
+
+    if ((unsigned)lumpnum >= numlumps)
+    {
+        return;
+    }
+
+    lump = lumpinfo[lumpnum];
+
+    if (lump->cache == NULL && lump->size > 0)
+    {
+        W_Prefetch(lump->wad_file, lump->position,
+                   lump->compressed > 0 ? lump->compressed : lump->size);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// [JN] Bounded cache of decompressed zip lumps.
+//      The zone may purge any of them on its own, which is noticed by
+//      the lump's cache pointer having been cleared.
+// -----------------------------------------------------------------------------
+
+static void UnlinkZipLump(lumpinfo_t *lump)
+{
+    if (lump->cache_prev != NULL)
+        lump->cache_prev->cache_next = lump->cache_next;
+    else
+        zip_cache_head = lump->cache_next;
+
+    if (lump->cache_next != NULL)
+        lump->cache_next->cache_prev = lump->cache_prev;
+    else
+        zip_cache_tail = lump->cache_prev;
+
+    lump->cache_prev = lump->cache_next = NULL;
+    zip_cache_size -= lump->size;
+}
+
+static void TouchZipLump(lumpinfo_t *lump)
+{
+    lumpinfo_t *rover;
+    lumpinfo_t *prev;
+
+    if (lump == zip_cache_head)
+    {
+        return;
+    }
+
+    if (lump->cache_prev != NULL || zip_cache_tail == lump)
+    {
+        UnlinkZipLump(lump);
+    }
+
+    lump->cache_next = zip_cache_head;
+    lump->cache_prev = NULL;
+    if (zip_cache_head != NULL)
+        zip_cache_head->cache_prev = lump;
+    else
+        zip_cache_tail = lump;
+    zip_cache_head = lump;
+    zip_cache_size += lump->size;
+
+    // Drop the least recently used lumps that are over the limit,
+    // but only those that are purgable: anything else is in use.
+
+    for (rover = zip_cache_tail;
+         rover != NULL && rover != lump && zip_cache_size > ZIP_CACHE_LIMIT;
+         rover = prev)
+    {
+        prev = rover->cache_prev;
+
+        if (rover->cache == NULL)
+        {
+            UnlinkZipLump(rover);
+        }
+        else if (Z_GetTag(rover->cache) >= PU_PURGELEVEL)
+        {
+            Z_Free(rover->cache);
+            UnlinkZipLump(rover);
+        }
+    }
+}
+
 //
 // W_CacheLumpNum
 //
@@ -438,7 +592,7 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
     // region.  If the lump is in an ordinary file, we may already
     // have it cached; otherwise, load it into memory.
 
-    if (lump->wad_file->mapped != NULL)
+    if (lump->wad_file->mapped != NULL && lump->compressed == 0)
     {
         // Memory mapped file, return from the mmapped region.
 
@@ -459,6 +613,11 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 	W_ReadLump (lumpnum, lump->cache);
         result = lump->cache;
     }
+
+    if (lump->compressed > 0)
+    {
+        TouchZipLump(lump);
+    }
 	
     return result;
 }
@@ -494,7 +653,7 @@ void W_ReleaseLumpNum(lumpindex_t lumpnum)
 
     lump = lumpinfo[lumpnum];
 
-    if (lump->wad_file->mapped != NULL)
+    if (lump->wad_file->mapped != NULL && lump->compressed == 0)
     {
         // Memory-mapped file, so nothing needs to be done here.
     }
@@ -509,6 +668,29 @@ void W_ReleaseLumpName(const char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
+// -----------------------------------------------------------------------------
+// W_LumpHandleNum
+// [JN] Lump number of a named lump handle. The name is only looked up
+//      on first use and after the lump directory has changed, so the
+//      drawers don't hash lump names every frame.
+// -----------------------------------------------------------------------------
+
+lumpindex_t W_LumpHandleNum(lumphandle_t *handle)
+{
+    if (handle->generation != lump_generation)
+    {
+        handle->lumpnum = W_GetNumForName(handle->name);
+        handle->generation = lump_generation;
+    }
+
+    return handle->lumpnum;
+}
+
+void *W_CacheLumpHandle(lumphandle_t *handle, int tag)
+{
+    return W_CacheLumpNum(W_LumpHandleNum(handle), tag);
+}
+
 // Generate a hash table for fast lookups
 
 void W_GenerateHashTable(void)
@@ -544,6 +726,8 @@ void W_GenerateHashTable(void)
         }
     }
 
+    ++lump_generation;
+
     // All done!
 }
 
@@ -64,9 +64,28 @@ struct lumpinfo_s
 
     // Used for hash table lookups
     lumpindex_t next;
+
+    // [JN] Size of the deflated data at "position" for lumps in zip
+    // archives, or 0 if the lump is stored as is.
+    int         compressed;
+
+    // [JN] Decompressed lumps currently cached, most recently used first.
+    lumpinfo_t *cache_prev;
+    lumpinfo_t *cache_next;
 };
 
 
+// [JN] Named lump handle, see W_LumpHandleNum.
+
+typedef struct
+{
+    const char *name;
+    lumpindex_t lumpnum;
+    unsigned int generation;
+} lumphandle_t;
+
+#define LUMPHANDLE(name) { (name), -1, 0 }
+
 extern lumpinfo_t **lumpinfo;
 extern unsigned int numlumps;
 
@@ -83,9 +102,13 @@ void W_ReadLump(lumpindex_t lump, void *dest);
 
 void *W_CacheLumpNum(lumpindex_t lump, int tag);
 void *W_CacheLumpName(const char *name, int tag);
+void W_PrefetchLumpNum(lumpindex_t lump);
 
 void W_GenerateHashTable(void);
 
+lumpindex_t W_LumpHandleNum(lumphandle_t *handle);
+void *W_CacheLumpHandle(lumphandle_t *handle, int tag);
+
 extern unsigned int W_LumpNameHash(const char *s);
 
 void W_ReleaseLumpNum(lumpindex_t lump);
@@ -0,0 +1,280 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Zip (pk3) resource archives.
+//
+//      Every file in the archive becomes a lump named after its base
+//      file name. Files in the "sprites/" and "flats/" directories are
+//      grouped between S_START/S_END and F_START/F_END markers, just
+//      as they would be in a PWAD. Stored files are read like ordinary
+//      WAD lumps, deflated ones are decompressed when they are cached.
+//
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "miniz.h"
+
+#include "w_zip.h"
+#include "z_zone.h"
+
+#define LOCAL_HEADER_SIZE   30
+#define LOCAL_HEADER_MAGIC  0x04034b50
+
+typedef enum
+{
+    SECTION_NORMAL,
+    SECTION_SPRITES,
+    SECTION_FLATS,
+    NUM_SECTIONS
+} section_t;
+
+static const char *section_dirs[NUM_SECTIONS] = { NULL, "sprites/", "flats/" };
+static const char *section_start[NUM_SECTIONS] = { NULL, "S_START", "F_START" };
+static const char *section_end[NUM_SECTIONS] = { NULL, "S_END", "F_END" };
+
+static boolean HasExtension(const char *filename, const char *ext)
+{
+    const size_t len = strlen(filename);
+
+    return len > 4 && !strcasecmp(filename + len - 4, ext);
+}
+
+boolean W_IsZipFile(const char *filename)
+{
+    return HasExtension(filename, ".zip") || HasExtension(filename, ".pk3");
+}
+
+static size_t ZipRead(void *opaque, mz_uint64 offset, void *buffer, size_t n)
+{
+    return W_Read(opaque, (unsigned int) offset, buffer, n);
+}
+
+static section_t SectionForPath(const char *path)
+{
+    int i;
+
+    for (i = SECTION_SPRITES; i < NUM_SECTIONS; ++i)
+    {
+        if (!strncasecmp(path, section_dirs[i], strlen(section_dirs[i])))
+        {
+            return i;
+        }
+    }
+
+    return SECTION_NORMAL;
+}
+
+// Lump name from the base file name, without the extension.
+
+static void LumpNameForPath(const char *path, char *name)
+{
+    const char *base = strrchr(path, '/');
+    int i;
+
+    base = base != NULL ? base + 1 : path;
+    memset(name, 0, 8);
+
+    for (i = 0; i < 8 && base[i] != '\0' && base[i] != '.'; ++i)
+    {
+        name[i] = toupper((int) base[i]);
+    }
+}
+
+static void AddMarker(ziplump_t *lump, const char *name)
+{
+    const size_t len = strlen(name);
+
+    memset(lump, 0, sizeof(*lump));
+    memcpy(lump->name, name, len < 8 ? len : 8);
+}
+
+// Offset of the file data: it follows the local header, whose name and
+// extra field lengths may differ from the central directory.
+
+static boolean FileDataOffset(wad_file_t *wad_file, mz_uint64 header_ofs,
+                              int *result)
+{
+    byte header[LOCAL_HEADER_SIZE];
+    unsigned int magic;
+
+    if (header_ofs + LOCAL_HEADER_SIZE > wad_file->length
+     || W_Read(wad_file, header_ofs, header, LOCAL_HEADER_SIZE)
+        != LOCAL_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    magic = header[0] | (header[1] << 8) | (header[2] << 16)
+          | ((unsigned int) header[3] << 24);
+
+    if (magic != LOCAL_HEADER_MAGIC)
+    {
+        return false;
+    }
+
+    *result = (int) header_ofs + LOCAL_HEADER_SIZE
+            + (header[26] | (header[27] << 8))
+            + (header[28] | (header[29] << 8));
+
+    return true;
+}
+
+int W_ReadZipDirectory(wad_file_t *wad_file, ziplump_t **lumps)
+{
+    mz_zip_archive zip;
+    mz_zip_archive_file_stat stat;
+    ziplump_t *result;
+    section_t section;
+    int numfiles;
+    int numlumps;
+    int position;
+    int i;
+
+    memset(&zip, 0, sizeof(zip));
+
+    if (wad_file->mapped != NULL)
+    {
+        if (!mz_zip_reader_init_mem(&zip, wad_file->mapped,
+                                    wad_file->length, 0))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        zip.m_pRead = ZipRead;
+        zip.m_pIO_opaque = wad_file;
+
+        if (!mz_zip_reader_init(&zip, wad_file->length, 0))
+        {
+            return -1;
+        }
+    }
+
+    numfiles = mz_zip_reader_get_num_files(&zip);
+
+    // Room for every file and a pair of markers per section.
+
+    result = Z_Malloc((numfiles + 2 * NUM_SECTIONS) * sizeof(ziplump_t),
+                      PU_STATIC, NULL);
+    numlumps = 0;
+
+    for (section = SECTION_NORMAL; section < NUM_SECTIONS; ++section)
+    {
+        const int section_lump = numlumps;
+
+        if (section_start[section] != NULL)
+        {
+            AddMarker(&result[numlumps++], section_start[section]);
+        }
+
+        for (i = 0; i < numfiles; ++i)
+        {
+            if (!mz_zip_reader_file_stat(&zip, i, &stat)
+             || stat.m_is_directory
+             || SectionForPath(stat.m_filename) != section)
+            {
+                continue;
+            }
+
+            // Maps packed as WAD files can't be used as lumps.
+
+            if (HasExtension(stat.m_filename, ".wad"))
+            {
+                printf(" skipping %s in %s\n", stat.m_filename,
+                       wad_file->path);
+                continue;
+            }
+
+            if (stat.m_is_encrypted
+             || (stat.m_method != 0 && stat.m_method != MZ_DEFLATED)
+             || stat.m_uncomp_size > INT_MAX
+             || !FileDataOffset(wad_file, stat.m_local_header_ofs,
+                                &position)
+             || position + stat.m_comp_size > wad_file->length)
+            {
+                printf(" unsupported file %s in %s\n", stat.m_filename,
+                       wad_file->path);
+                continue;
+            }
+
+            result[numlumps].filepos = position;
+            result[numlumps].size = (int) stat.m_uncomp_size;
+            result[numlumps].compressed =
+                stat.m_method == MZ_DEFLATED ? (int) stat.m_comp_size : 0;
+            LumpNameForPath(stat.m_filename, result[numlumps].name);
+            ++numlumps;
+        }
+
+        if (section_end[section] != NULL)
+        {
+            // Don't leave empty sections behind.
+
+            if (numlumps == section_lump + 1)
+            {
+                --numlumps;
+            }
+            else
+            {
+                AddMarker(&result[numlumps++], section_end[section]);
+            }
+        }
+    }
+
+    mz_zip_reader_end(&zip);
+
+    *lumps = result;
+
+    return numlumps;
+}
+
+boolean W_InflateLump(wad_file_t *wad_file, int position, int compressed,
+                      void *dest, int size)
+{
+    byte *src;
+    size_t result;
+
+    // Zero-copy from a mapped archive, otherwise read the deflated data
+    // into a temporary buffer. Not zone memory, as that could purge the
+    // cache block being filled.
+
+    if (wad_file->mapped != NULL)
+    {
+        src = wad_file->mapped + position;
+    }
+    else
+    {
+        src = malloc(compressed);
+
+        if (src == NULL
+         || W_Read(wad_file, position, src, compressed) < compressed)
+        {
+            free(src);
+            return false;
+        }
+    }
+
+    result = tinfl_decompress_mem_to_mem(dest, size, src, compressed, 0);
+
+    if (wad_file->mapped == NULL)
+    {
+        free(src);
+    }
+
+    return result == (size_t) size;
+}
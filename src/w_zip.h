@@ -0,0 +1,52 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Zip (pk3) resource archives.
+//
+
+
+#ifndef __W_ZIP__
+#define __W_ZIP__
+
+#include "doomtype.h"
+#include "w_file.h"
+
+typedef struct
+{
+    // Offset of the lump data in the archive.
+    int         filepos;
+
+    // Uncompressed size.
+    int         size;
+
+    // Size of the deflated data, or 0 if the lump is stored.
+    int         compressed;
+
+    char        name[8];
+} ziplump_t;
+
+// Whether the file name has a zip or pk3 extension.
+boolean W_IsZipFile(const char *filename);
+
+// Index the central directory of a zip archive. Returns the number of
+// lumps and a Z_Malloc'ed array of them, or -1 if the archive can not
+// be read.
+int W_ReadZipDirectory(wad_file_t *wad_file, ziplump_t **lumps);
+
+// Decompress deflated lump data at the given offset into dest, which
+// must be "size" bytes long.
+boolean W_InflateLump(wad_file_t *wad_file, int position, int compressed,
+                      void *dest, int size);
+
+#endif
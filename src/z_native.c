@@ -237,7 +237,7 @@ static boolean ClearCache(int size)
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
 //
 
-void *Z_Malloc(int size, int tag, void *user)
+void *Z_Malloc2(int size, int tag, void *user, const char *file, int line)
 {
     memblock_t *newblock;
     unsigned char *data;
@@ -488,6 +488,22 @@ void Z_ChangeUser(void *ptr, void **user)
     *user = ptr;
 }
 
+// [JN] Purge tag of a block.
+
+int Z_GetTag(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_GetTag: block without a ZONEID!");
+    }
+
+    return block->tag;
+}
+
 
 //
 // Z_FreeMemory
@@ -500,6 +516,11 @@ int Z_FreeMemory(void)
     return -1;
 }
 
+int Z_LargestFree(void)
+{
+    return -1;
+}
+
 unsigned int Z_ZoneSize(void)
 {
     return 0;
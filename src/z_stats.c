@@ -0,0 +1,264 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Zone memory statistics.
+//
+//      Counters by tag are always kept, they are shown by the zone
+//      widget. Counters by call site (the __FILE__ and __LINE__ of the
+//      Z_Malloc call) cost a hash lookup per allocation, so they are
+//      only kept with -zonestats.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomtype.h"
+#include "i_system.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "z_stats.h"
+
+
+#define MAX_SITES 1024  // must be a power of two
+
+typedef struct
+{
+    const char *file;
+    int line;
+    int allocs;
+    int live;
+    int peak;
+    int purges;
+} zonesite_t;
+
+zonestats_t zonestats;
+
+static boolean stats_initialized = false;
+static boolean count_sites = false;
+static zonesite_t sites[MAX_SITES];
+static int numsites;
+static int allocs_this_tic;
+static int purges_this_tic;
+
+static const char *tag_names[PU_NUM_TAGS] = {
+    NULL, "PU_STATIC", "PU_SOUND", "PU_MUSIC", "PU_FREE",
+    "PU_LEVEL", "PU_LEVSPEC", "PU_PURGELEVEL", "PU_CACHE",
+};
+
+static void AddLive(int tag, int size)
+{
+    zonestats.live[tag] += size;
+    zonestats.live_total += size;
+
+    if (zonestats.live[tag] > zonestats.peak[tag])
+    {
+        zonestats.peak[tag] = zonestats.live[tag];
+    }
+    if (zonestats.live_total > zonestats.peak_total)
+    {
+        zonestats.peak_total = zonestats.live_total;
+    }
+}
+
+// Find or add the entry for a call site. The same __FILE__ string may
+// have different addresses in different translation units, so the
+// names are compared if the pointers differ.
+
+static int SiteIndex(const char *file, int line)
+{
+    unsigned int i;
+
+    i = ((unsigned int) line * 2654435761U) & (MAX_SITES - 1);
+
+    while (sites[i].file != NULL)
+    {
+        if (sites[i].line == line
+         && (sites[i].file == file || !strcmp(sites[i].file, file)))
+        {
+            return i;
+        }
+
+        i = (i + 1) & (MAX_SITES - 1);
+    }
+
+    // Keep a free slot, so that lookups always end.
+
+    if (numsites >= MAX_SITES - 1)
+    {
+        return -1;
+    }
+
+    ++numsites;
+    sites[i].file = file;
+    sites[i].line = line;
+
+    return i;
+}
+
+int Z_StatsAlloc(int tag, int size, const char *file, int line)
+{
+    int site;
+
+    ++zonestats.allocs[tag];
+    ++allocs_this_tic;
+    AddLive(tag, size);
+
+    if (!count_sites || (site = SiteIndex(file, line)) < 0)
+    {
+        return -1;
+    }
+
+    ++sites[site].allocs;
+    sites[site].live += size;
+
+    if (sites[site].live > sites[site].peak)
+    {
+        sites[site].peak = sites[site].live;
+    }
+
+    return site;
+}
+
+void Z_StatsFree(int tag, int size, int site)
+{
+    zonestats.live[tag] -= size;
+    zonestats.live_total -= size;
+
+    if (site >= 0)
+    {
+        sites[site].live -= size;
+    }
+}
+
+void Z_StatsChangeTag(int oldtag, int newtag, int size)
+{
+    zonestats.live[oldtag] -= size;
+    zonestats.live_total -= size;
+    AddLive(newtag, size);
+}
+
+void Z_StatsPurge(int tag, int site)
+{
+    ++zonestats.purges[tag];
+    ++purges_this_tic;
+
+    if (site >= 0)
+    {
+        ++sites[site].purges;
+    }
+}
+
+void Z_StatsTic(void)
+{
+    zonestats.tic_allocs = allocs_this_tic;
+    zonestats.tic_purges = purges_this_tic;
+
+    if (allocs_this_tic > zonestats.peak_tic_allocs)
+    {
+        zonestats.peak_tic_allocs = allocs_this_tic;
+    }
+
+    allocs_this_tic = 0;
+    purges_this_tic = 0;
+}
+
+// Sort call sites by peak live bytes, largest first.
+
+static int CompareSites(const void *a, const void *b)
+{
+    const zonesite_t *sa = &sites[*(const int *) a];
+    const zonesite_t *sb = &sites[*(const int *) b];
+
+    return (sb->peak > sa->peak) - (sb->peak < sa->peak);
+}
+
+static void Z_StatsDump(void)
+{
+    int order[MAX_SITES];
+    int count;
+    int i;
+
+    printf("\nZone memory statistics (zone size %u, largest free block %i)\n",
+           Z_ZoneSize(), Z_LargestFree());
+    printf("%-14s %10s %10s %10s %8s\n",
+           "tag", "live", "peak", "allocs", "purges");
+
+    for (i = PU_STATIC; i < PU_NUM_TAGS; ++i)
+    {
+        if (i == PU_FREE)
+        {
+            continue;
+        }
+
+        printf("%-14s %10i %10i %10i %8i\n", tag_names[i],
+               zonestats.live[i], zonestats.peak[i],
+               zonestats.allocs[i], zonestats.purges[i]);
+    }
+
+    printf("%-14s %10i %10i\n", "total",
+           zonestats.live_total, zonestats.peak_total);
+    printf("most allocations in a tic: %i\n", zonestats.peak_tic_allocs);
+
+    count = 0;
+
+    for (i = 0; i < MAX_SITES; ++i)
+    {
+        if (sites[i].file != NULL)
+        {
+            order[count++] = i;
+        }
+    }
+
+    qsort(order, count, sizeof(*order), CompareSites);
+
+    printf("\n%-32s %10s %10s %10s %8s\n",
+           "call site", "live", "peak", "allocs", "purges");
+
+    for (i = 0; i < count; ++i)
+    {
+        const zonesite_t *site = &sites[order[i]];
+        char name[64];
+
+        M_snprintf(name, sizeof(name), "%s:%i",
+                   M_BaseName(site->file), site->line);
+        printf("%-32s %10i %10i %10i %8i\n", name,
+               site->live, site->peak, site->allocs, site->purges);
+    }
+}
+
+void Z_StatsInit(void)
+{
+    // [crispy] Z_Init is called again when the zone grows.
+
+    if (stats_initialized)
+    {
+        return;
+    }
+
+    stats_initialized = true;
+
+    //!
+    // @category obscure
+    //
+    // Count zone memory allocations by call site, and print zone
+    // memory statistics at exit.
+    //
+
+    if (M_ParmExists("-zonestats"))
+    {
+        count_sites = true;
+        I_AtExit(Z_StatsDump, true);
+    }
+}
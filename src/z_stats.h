@@ -0,0 +1,55 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Zone memory statistics.
+//
+
+
+#ifndef __Z_STATS__
+#define __Z_STATS__
+
+#include "z_zone.h"
+
+typedef struct
+{
+    int live[PU_NUM_TAGS];      // bytes in blocks with each tag
+    int peak[PU_NUM_TAGS];      // highest live bytes of each tag
+    int allocs[PU_NUM_TAGS];    // number of allocations with each tag
+    int purges[PU_NUM_TAGS];    // blocks thrown out to make room
+
+    int live_total;
+    int peak_total;
+
+    int tic_allocs;             // allocations during the last tic
+    int tic_purges;             // purges during the last tic
+    int peak_tic_allocs;
+} zonestats_t;
+
+extern zonestats_t zonestats;
+
+// Called by Z_Init. With -zonestats, also count by call site and
+// print everything at exit.
+void Z_StatsInit(void);
+
+// Called once per game tic, to update the per tic counters.
+void Z_StatsTic(void);
+
+// Hooks for the allocator. Z_StatsAlloc returns the call site index
+// to be passed to Z_StatsFree, or -1 if call sites are not counted.
+int Z_StatsAlloc(int tag, int size, const char *file, int line);
+void Z_StatsFree(int tag, int size, int site);
+void Z_StatsChangeTag(int oldtag, int newtag, int size);
+void Z_StatsPurge(int tag, int site);
+
+#endif
@@ -0,0 +1,791 @@
+//
+// Copyright(C) 1993-1996 Id Software, Inc.
+// Copyright(C) 2005-2014 Simon Howard
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Segregated-fit zone memory allocator.
+//
+//      A drop-in replacement for z_zone.c, selected with the
+//      ENABLE_TLSF_ZONE build option. Free blocks are kept in two-level
+//      size class lists (TLSF), so that allocating and freeing do not
+//      walk the heap. Allocated blocks are kept in one list per tag,
+//      so that Z_FreeTags only visits the blocks it frees, and purgable
+//      blocks are thrown out least recently tagged first when the
+//      zone is full.
+//
+
+#include <string.h>
+
+#include "doomtype.h"
+#include "i_system.h"
+#include "m_argv.h"
+#include "z_stats.h"
+#include "z_zone.h"
+
+
+#define ZONEID	0x1d4a11
+
+// Block sizes are multiples of this, on every platform.
+
+#define MEM_ALIGN       8
+
+// Size classes: sizes below SMALL_BLOCK are split linearly into
+// SL_COUNT lists, larger sizes into SL_COUNT lists per power of two.
+
+#define SL_SHIFT        4
+#define SL_COUNT        (1 << SL_SHIFT)
+#define FL_SHIFT        (SL_SHIFT + 3)
+#define SMALL_BLOCK     (1 << FL_SHIFT)
+#define FL_COUNT        (32 - FL_SHIFT + 1)
+
+// Don't split off free fragments smaller than this.
+
+#define MINFRAGMENT     64
+
+typedef struct memblock_s
+{
+    int                 size;   // including the header
+    int                 site;   // call site index for -zonestats
+    void**              user;
+    int                 tag;    // PU_FREE if this is free
+    int                 id;     // should be ZONEID
+    struct memblock_s*  prev_phys;  // block before this one in the pool
+
+    // Size class list if the block is free, tag list otherwise.
+    struct memblock_s*  next;
+    struct memblock_s*  prev;
+} memblock_t;
+
+#define HEADER_SIZE \
+    ((int) (sizeof(memblock_t) + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1))
+
+#define BlockData(block)    ((void *) ((byte *) (block) + HEADER_SIZE))
+#define DataBlock(ptr)      ((memblock_t *) ((byte *) (ptr) - HEADER_SIZE))
+#define NextPhys(block)     ((memblock_t *) ((byte *) (block) + (block)->size))
+
+// Memory obtained from I_ZoneBase. Each pool ends with a header-sized
+// PU_STATIC sentinel, so that free blocks never merge past its end.
+
+typedef struct pool_s
+{
+    int             size;
+    struct pool_s*  next;
+} pool_t;
+
+#define POOL_HEADER \
+    ((int) (sizeof(pool_t) + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1))
+
+#define PoolBlocks(pool)    ((memblock_t *) ((byte *) (pool) + POOL_HEADER))
+
+static pool_t *pools;
+static unsigned int total_size;
+
+static unsigned int fl_bitmap;
+static unsigned int sl_bitmap[FL_COUNT];
+static memblock_t *free_lists[FL_COUNT][SL_COUNT];
+static int free_bytes;
+
+// Allocated blocks by tag, most recently tagged first.
+
+static memblock_t *tag_head[PU_NUM_TAGS];
+static memblock_t *tag_tail[PU_NUM_TAGS];
+static int tag_bytes[PU_NUM_TAGS];
+
+static boolean zero_on_free;
+static boolean scan_on_free;
+
+
+// Index of the most significant set bit.
+
+static int FindLastSet(unsigned int x)
+{
+    int result = 0;
+
+    if (x & 0xffff0000) { x >>= 16; result += 16; }
+    if (x & 0xff00)     { x >>= 8;  result += 8;  }
+    if (x & 0xf0)       { x >>= 4;  result += 4;  }
+    if (x & 0xc)        { x >>= 2;  result += 2;  }
+    if (x & 0x2)        {           result += 1;  }
+
+    return result;
+}
+
+static int FindFirstSet(unsigned int x)
+{
+    return FindLastSet(x & (~x + 1));
+}
+
+static void Mapping(int size, int *fl, int *sl)
+{
+    if (size < SMALL_BLOCK)
+    {
+        *fl = 0;
+        *sl = size / (SMALL_BLOCK / SL_COUNT);
+    }
+    else
+    {
+        const int f = FindLastSet(size);
+
+        *sl = (size >> (f - SL_SHIFT)) ^ SL_COUNT;
+        *fl = f - FL_SHIFT + 1;
+    }
+}
+
+//
+// Free lists
+//
+
+static void InsertFree(memblock_t *block)
+{
+    int fl, sl;
+
+    Mapping(block->size, &fl, &sl);
+
+    block->tag = PU_FREE;
+    block->user = NULL;
+    block->id = 0;
+    block->prev = NULL;
+    block->next = free_lists[fl][sl];
+
+    if (block->next != NULL)
+    {
+        block->next->prev = block;
+    }
+
+    free_lists[fl][sl] = block;
+    fl_bitmap |= 1U << fl;
+    sl_bitmap[fl] |= 1U << sl;
+    free_bytes += block->size;
+}
+
+static void RemoveFree(memblock_t *block)
+{
+    int fl, sl;
+
+    Mapping(block->size, &fl, &sl);
+
+    if (block->prev != NULL)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        free_lists[fl][sl] = block->next;
+
+        if (block->next == NULL)
+        {
+            sl_bitmap[fl] &= ~(1U << sl);
+
+            if (sl_bitmap[fl] == 0)
+            {
+                fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+
+    if (block->next != NULL)
+    {
+        block->next->prev = block->prev;
+    }
+
+    free_bytes -= block->size;
+}
+
+// Take a free block of at least the given size off its list, or
+// return NULL. Sizes are rounded up to the next size class, so that
+// any block in the list found is large enough.
+
+static memblock_t *FindFree(int size)
+{
+    unsigned int map;
+    memblock_t *block;
+    int fl, sl;
+
+    if (size >= SMALL_BLOCK)
+    {
+        size += (1 << (FindLastSet(size) - SL_SHIFT)) - 1;
+    }
+
+    Mapping(size, &fl, &sl);
+
+    if (fl >= FL_COUNT)
+    {
+        return NULL;
+    }
+
+    map = sl_bitmap[fl] & (~0U << sl);
+
+    if (map == 0)
+    {
+        if (fl + 1 >= FL_COUNT)
+        {
+            return NULL;
+        }
+
+        map = fl_bitmap & (~0U << (fl + 1));
+
+        if (map == 0)
+        {
+            return NULL;
+        }
+
+        fl = FindFirstSet(map);
+        map = sl_bitmap[fl];
+    }
+
+    sl = FindFirstSet(map);
+    block = free_lists[fl][sl];
+    RemoveFree(block);
+
+    return block;
+}
+
+//
+// Tag lists
+//
+
+static void InsertTag(memblock_t *block)
+{
+    const int tag = block->tag;
+
+    block->prev = NULL;
+    block->next = tag_head[tag];
+
+    if (block->next != NULL)
+    {
+        block->next->prev = block;
+    }
+    else
+    {
+        tag_tail[tag] = block;
+    }
+
+    tag_head[tag] = block;
+    tag_bytes[tag] += block->size;
+}
+
+static void RemoveTag(memblock_t *block)
+{
+    const int tag = block->tag;
+
+    if (block->prev != NULL)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        tag_head[tag] = block->next;
+    }
+
+    if (block->next != NULL)
+    {
+        block->next->prev = block->prev;
+    }
+    else
+    {
+        tag_tail[tag] = block->prev;
+    }
+
+    tag_bytes[tag] -= block->size;
+}
+
+static void CheckTag(int tag, const char *func)
+{
+    if (tag < PU_STATIC || tag >= PU_NUM_TAGS || tag == PU_FREE)
+    {
+        I_Error("%s: invalid tag %i", func, tag);
+    }
+}
+
+//
+// Pools
+//
+
+static void AddPool(void)
+{
+    pool_t *pool;
+    memblock_t *block, *sentinel;
+    int size;
+
+    pool = (pool_t *) I_ZoneBase(&size);
+    pool->size = size & ~(MEM_ALIGN - 1);
+    pool->next = pools;
+    pools = pool;
+    total_size += pool->size;
+
+    // One free block covering the pool, followed by the sentinel.
+
+    block = PoolBlocks(pool);
+    block->size = pool->size - POOL_HEADER - HEADER_SIZE;
+    block->prev_phys = NULL;
+
+    sentinel = NextPhys(block);
+    sentinel->size = HEADER_SIZE;
+    sentinel->user = NULL;
+    sentinel->tag = PU_STATIC;
+    sentinel->id = 0;
+    sentinel->prev_phys = block;
+
+    InsertFree(block);
+}
+
+//
+// Z_Init
+//
+void Z_Init (void)
+{
+    pools = NULL;
+    total_size = 0;
+    fl_bitmap = 0;
+    free_bytes = 0;
+    memset(sl_bitmap, 0, sizeof(sl_bitmap));
+    memset(free_lists, 0, sizeof(free_lists));
+    memset(tag_head, 0, sizeof(tag_head));
+    memset(tag_tail, 0, sizeof(tag_tail));
+    memset(tag_bytes, 0, sizeof(tag_bytes));
+
+    AddPool();
+
+    // [Deliberately undocumented]
+    // Zone memory debugging flag. If set, memory is zeroed after it is freed
+    // to deliberately break any code that attempts to use it after free.
+    //
+    zero_on_free = M_ParmExists("-zonezero");
+
+    // [Deliberately undocumented]
+    // Zone memory debugging flag. If set, each time memory is freed, the zone
+    // heap is scanned to look for remaining pointers to the freed block.
+    //
+    scan_on_free = M_ParmExists("-zonescan");
+
+    Z_StatsInit();
+}
+
+// Scan the zone heap for pointers within the specified range, and warn about
+// any remaining pointers.
+static void ScanForBlock(void *start, void *end)
+{
+    static const int scan_tags[] = { PU_STATIC, PU_LEVEL, PU_LEVSPEC };
+    memblock_t *block;
+    void **mem;
+    int i, j, len;
+
+    for (j = 0; j < arrlen(scan_tags); ++j)
+    {
+        for (block = tag_head[scan_tags[j]]; block != NULL;
+             block = block->next)
+        {
+            // Scan for pointers on the assumption that pointers are aligned
+            // on word boundaries (word size depending on pointer size):
+            mem = (void **) BlockData(block);
+            len = (block->size - HEADER_SIZE) / sizeof(void *);
+
+            for (i = 0; i < len; ++i)
+            {
+                if (start <= mem[i] && mem[i] <= end)
+                {
+                    fprintf(stderr,
+                            "%p has dangling pointer into freed block "
+                            "%p (%p -> %p)\n",
+                            (void*)mem, start, (void*)&mem[i], mem[i]);
+                }
+            }
+        }
+    }
+}
+
+//
+// Z_Free
+//
+void Z_Free (void* ptr)
+{
+    memblock_t*		block;
+    memblock_t*		other;
+
+    block = DataBlock(ptr);
+
+    if (block->id != ZONEID)
+	I_Error ("Z_Free: freed a pointer without ZONEID");
+
+    if (block->user != NULL)
+    {
+    	// clear the user's mark
+	    *block->user = 0;
+    }
+
+    Z_StatsFree(block->tag, block->size, block->site);
+    RemoveTag(block);
+    block->id = 0;
+
+    // If the -zonezero flag is provided, we zero out the block on free
+    // to break code that depends on reading freed memory.
+    if (zero_on_free)
+    {
+        memset(ptr, 0, block->size - HEADER_SIZE);
+    }
+    if (scan_on_free)
+    {
+        ScanForBlock(ptr, (byte *) ptr + block->size - HEADER_SIZE);
+    }
+
+    other = block->prev_phys;
+
+    if (other != NULL && other->tag == PU_FREE)
+    {
+        // merge with previous free block
+        RemoveFree(other);
+        other->size += block->size;
+        block = other;
+    }
+
+    other = NextPhys(block);
+
+    if (other->tag == PU_FREE)
+    {
+        // merge the next free block onto the end
+        RemoveFree(other);
+        block->size += other->size;
+    }
+
+    NextPhys(block)->prev_phys = block;
+    InsertFree(block);
+}
+
+// Throw out the least recently tagged purgable block. Returns false
+// if there are none left.
+
+static boolean PurgeBlock(void)
+{
+    int tag;
+
+    for (tag = PU_NUM_TAGS - 1; tag >= PU_PURGELEVEL; --tag)
+    {
+        if (tag_tail[tag] != NULL)
+        {
+            Z_StatsPurge(tag, tag_tail[tag]->site);
+            Z_Free(BlockData(tag_tail[tag]));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+//
+void*
+Z_Malloc2
+( int		size,
+  int		tag,
+  void*		user,
+  const char*	file,
+  int		line )
+{
+    int		extra;
+    memblock_t*	base;
+    memblock_t*	newblock;
+    void *result;
+
+    CheckTag(tag, "Z_Malloc");
+
+    if (user == NULL && tag >= PU_PURGELEVEL)
+        I_Error ("Z_Malloc: an owner is required for purgable blocks");
+
+    // account for size of block header
+    size = ((size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1)) + HEADER_SIZE;
+
+    while ((base = FindFree(size)) == NULL)
+    {
+        // throw out purgable blocks until one fits,
+        // [crispy] otherwise allocate another zone twice as big
+        if (!PurgeBlock())
+        {
+            AddPool();
+        }
+    }
+
+    // found a block big enough
+    extra = base->size - size;
+
+    if (extra > MINFRAGMENT)
+    {
+        // there will be a free fragment after the allocated block
+        newblock = (memblock_t *) ((byte *) base + size);
+        newblock->size = extra;
+        newblock->prev_phys = base;
+        NextPhys(newblock)->prev_phys = newblock;
+        base->size = size;
+
+        InsertFree(newblock);
+    }
+
+    base->user = user;
+    base->tag = tag;
+    base->id = ZONEID;
+    base->site = Z_StatsAlloc(tag, base->size, file, line);
+    InsertTag(base);
+
+    result = BlockData(base);
+
+    if (base->user)
+    {
+        *base->user = result;
+    }
+
+    return result;
+}
+
+//
+// Z_FreeTags
+//
+void
+Z_FreeTags
+( int		lowtag,
+  int		hightag )
+{
+    int tag;
+
+    if (lowtag < PU_STATIC)
+        lowtag = PU_STATIC;
+
+    if (hightag >= PU_NUM_TAGS)
+        hightag = PU_NUM_TAGS - 1;
+
+    for (tag = lowtag; tag <= hightag; ++tag)
+    {
+        if (tag == PU_FREE)
+            continue;
+
+        while (tag_head[tag] != NULL)
+        {
+            Z_Free(BlockData(tag_head[tag]));
+        }
+    }
+}
+
+//
+// Z_DumpHeap
+// Note: TFileDumpHeap( stdout ) ?
+//
+void
+Z_DumpHeap
+( int		lowtag,
+  int		hightag )
+{
+    pool_t*	pool;
+    memblock_t*	block;
+    byte*	end;
+
+    printf ("zone size: %u  pools: %p\n", total_size, (void*)pools);
+
+    printf ("tag range: %i to %i\n", lowtag, hightag);
+
+    for (pool = pools; pool != NULL; pool = pool->next)
+    {
+        end = (byte *) pool + pool->size - HEADER_SIZE;
+
+        for (block = PoolBlocks(pool); (byte *) block != end;
+             block = NextPhys(block))
+        {
+            if (block->tag >= lowtag && block->tag <= hightag)
+                printf ("block:%p    size:%7i    user:%p    tag:%3i\n",
+                        (void*)block, block->size, (void*)block->user,
+                        block->tag);
+
+            if (NextPhys(block)->prev_phys != block)
+                printf ("ERROR: next block doesn't have proper back link\n");
+
+            if (block->tag == PU_FREE && NextPhys(block)->tag == PU_FREE)
+                printf ("ERROR: two consecutive free blocks\n");
+        }
+    }
+}
+
+//
+// Z_FileDumpHeap
+//
+void Z_FileDumpHeap (FILE* f)
+{
+    pool_t*	pool;
+    memblock_t*	block;
+    byte*	end;
+    int		tag;
+
+    fprintf (f,"zone size: %u  pools: %p\n", total_size, (void*)pools);
+
+    for (tag = PU_STATIC; tag < PU_NUM_TAGS; ++tag)
+    {
+        if (tag != PU_FREE)
+            fprintf (f,"tag %i: %i bytes\n", tag, tag_bytes[tag]);
+    }
+
+    for (pool = pools; pool != NULL; pool = pool->next)
+    {
+        end = (byte *) pool + pool->size - HEADER_SIZE;
+
+        for (block = PoolBlocks(pool); (byte *) block != end;
+             block = NextPhys(block))
+        {
+            fprintf (f,"block:%p    size:%7i    user:%p    tag:%3i\n",
+                     (void*)block, block->size, (void*)block->user,
+                     block->tag);
+
+            if (NextPhys(block)->prev_phys != block)
+                fprintf (f,"ERROR: next block doesn't have proper back link\n");
+
+            if (block->tag == PU_FREE && NextPhys(block)->tag == PU_FREE)
+                fprintf (f,"ERROR: two consecutive free blocks\n");
+        }
+    }
+}
+
+//
+// Z_CheckHeap
+//
+void Z_CheckHeap (void)
+{
+    pool_t*	pool;
+    memblock_t*	block;
+    byte*	end;
+
+    for (pool = pools; pool != NULL; pool = pool->next)
+    {
+        end = (byte *) pool + pool->size - HEADER_SIZE;
+
+        for (block = PoolBlocks(pool); (byte *) block != end;
+             block = NextPhys(block))
+        {
+            if (block->size < HEADER_SIZE || (byte *) NextPhys(block) > end)
+                I_Error ("Z_CheckHeap: block size does not touch the next block\n");
+
+            if (NextPhys(block)->prev_phys != block)
+                I_Error ("Z_CheckHeap: next block doesn't have proper back link\n");
+
+            if (block->tag == PU_FREE && NextPhys(block)->tag == PU_FREE)
+                I_Error ("Z_CheckHeap: two consecutive free blocks\n");
+
+            if (block->tag != PU_FREE && block->id != ZONEID)
+                I_Error ("Z_CheckHeap: allocated block without a ZONEID\n");
+        }
+    }
+}
+
+//
+// Z_ChangeTag
+//
+void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
+{
+    memblock_t*	block;
+
+    block = DataBlock(ptr);
+
+    if (block->id != ZONEID)
+        I_Error("%s:%i: Z_ChangeTag: block without a ZONEID!",
+                file, line);
+
+    if (tag >= PU_PURGELEVEL && block->user == NULL)
+        I_Error("%s:%i: Z_ChangeTag: an owner is required "
+                "for purgable blocks", file, line);
+
+    CheckTag(tag, "Z_ChangeTag");
+
+    // Moves the block to the front of the new tag list, so that
+    // recently used cache blocks are purged last.
+
+    Z_StatsChangeTag(block->tag, tag, block->size);
+    RemoveTag(block);
+    block->tag = tag;
+    InsertTag(block);
+}
+
+void Z_ChangeUser(void *ptr, void **user)
+{
+    memblock_t*	block;
+
+    block = DataBlock(ptr);
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_ChangeUser: Tried to change user for invalid block!");
+    }
+
+    block->user = user;
+    *user = ptr;
+}
+
+// [JN] Purge tag of a block.
+
+int Z_GetTag(void *ptr)
+{
+    memblock_t*	block;
+
+    block = DataBlock(ptr);
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_GetTag: block without a ZONEID!");
+    }
+
+    return block->tag;
+}
+
+//
+// Z_FreeMemory
+//
+int Z_FreeMemory (void)
+{
+    int		free;
+    int		tag;
+
+    free = free_bytes;
+
+    for (tag = PU_PURGELEVEL; tag < PU_NUM_TAGS; ++tag)
+    {
+        free += tag_bytes[tag];
+    }
+
+    return free;
+}
+
+// [JN] Largest free block, a measure of how fragmented the zone is.
+// Only the highest non-empty size class has to be searched.
+
+int Z_LargestFree (void)
+{
+    memblock_t*	block;
+    int		largest;
+    int		fl, sl;
+
+    if (fl_bitmap == 0)
+        return 0;
+
+    fl = FindLastSet(fl_bitmap);
+    sl = FindLastSet(sl_bitmap[fl]);
+    largest = 0;
+
+    for (block = free_lists[fl][sl]; block != NULL; block = block->next)
+    {
+        if (block->size > largest)
+            largest = block->size;
+    }
+
+    return largest;
+}
+
+unsigned int Z_ZoneSize(void)
+{
+    return total_size;
+}
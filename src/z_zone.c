@@ -22,6 +22,7 @@
 #include "doomtype.h"
 #include "i_system.h"
 #include "m_argv.h"
+#include "z_stats.h"
 #include "z_zone.h"
 
 #include "id_vars.h"
@@ -44,6 +45,7 @@
 typedef struct memblock_s
 {
     int			size;	// including the header and possibly tiny fragments
+    int			site;	// call site index for -zonestats
     void**		user;
     int			tag;	// PU_FREE if this is free
     int			id;	// should be ZONEID
@@ -52,7 +54,7 @@ typedef struct memblock_s
 } memblock_t;
 
 
-typedef struct
+typedef struct memzone_s
 {
     // total bytes malloced, including header
     int		size;
@@ -61,6 +63,9 @@ typedef struct
     memblock_t	blocklist;
     
     memblock_t*	rover;
+
+    // [JN] zone that was allocated before this one, when the zone grew
+    struct memzone_s*	next;
     
 } memzone_t;
 
@@ -103,10 +108,15 @@ void Z_ClearZone (memzone_t* zone)
 void Z_Init (void)
 {
     memblock_t*	block;
+    memzone_t*	oldzone;
     int		size;
 
+    // [JN] Blocks in earlier zones are still in use, keep them listed.
+    oldzone = mainzone;
+
     mainzone = (memzone_t *)I_ZoneBase (&size);
     mainzone->size = size;
+    mainzone->next = oldzone;
 
     // set the entire zone to one free block
     mainzone->blocklist.next =
@@ -135,6 +145,8 @@ void Z_Init (void)
     // heap is scanned to look for remaining pointers to the freed block.
     //
     scan_on_free = M_ParmExists("-zonescan");
+
+    Z_StatsInit();
 }
 
 // Scan the zone heap for pointers within the specified range, and warn about
@@ -193,6 +205,11 @@ void Z_Free (void* ptr)
 	    *block->user = 0;
     }
 
+    if (block->tag != PU_FREE)
+    {
+        Z_StatsFree(block->tag, block->size, block->site);
+    }
+
     // mark as free
     block->tag = PU_FREE;
     block->user = NULL;
@@ -248,10 +265,12 @@ void Z_Free (void* ptr)
 
 
 void*
-Z_Malloc
+Z_Malloc2
 ( int		size,
   int		tag,
-  void*		user )
+  void*		user,
+  const char*	file,
+  int		line )
 {
     int		extra;
     memblock_t*	start;
@@ -309,6 +328,7 @@ Z_Malloc
 
                 // the rover can be the base block
                 base = base->prev;
+                Z_StatsPurge(rover->tag, rover->site);
                 Z_Free ((byte *)rover+sizeof(memblock_t));
                 base = base->next;
                 rover = base->next;
@@ -358,6 +378,7 @@ Z_Malloc
     mainzone->rover = base->next;	
 	
     base->id = ZONEID;
+    base->site = Z_StatsAlloc(tag, base->size, file, line);
    
     return result;
 }
@@ -513,6 +534,7 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
         I_Error("%s:%i: Z_ChangeTag: an owner is required "
                 "for purgable blocks", file, line);
 
+    Z_StatsChangeTag(block->tag, tag, block->size);
     block->tag = tag;
 }
 
@@ -531,6 +553,22 @@ void Z_ChangeUser(void *ptr, void **user)
     *user = ptr;
 }
 
+// [JN] Purge tag of a block.
+
+int Z_GetTag(void *ptr)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID)
+    {
+        I_Error("Z_GetTag: block without a ZONEID!");
+    }
+
+    return block->tag;
+}
+
 
 
 //
@@ -554,8 +592,44 @@ int Z_FreeMemory (void)
     return free;
 }
 
+// [JN] Largest free block, a measure of how fragmented the zone is.
+
+// All zones are searched, as the zone may have grown.
+
+int Z_LargestFree (void)
+{
+    memzone_t*		zone;
+    memblock_t*		block;
+    int			largest;
+
+    largest = 0;
+
+    for (zone = mainzone ; zone != NULL ; zone = zone->next)
+    {
+        for (block = zone->blocklist.next ;
+             block != &zone->blocklist;
+             block = block->next)
+        {
+            if (block->tag == PU_FREE && block->size > largest)
+                largest = block->size;
+        }
+    }
+
+    return largest;
+}
+
 unsigned int Z_ZoneSize(void)
 {
-    return mainzone->size;
+    memzone_t*		zone;
+    unsigned int	size;
+
+    size = 0;
+
+    for (zone = mainzone ; zone != NULL ; zone = zone->next)
+    {
+        size += zone->size;
+    }
+
+    return size;
 }
 